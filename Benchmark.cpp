@@ -0,0 +1,210 @@
+#include "Benchmark.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "Includes/header.h"
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+
+/// @brief the framebuffer the benchmark renders to instead of the window: SCR_WIDTH x SCR_HEIGHT RGBA8 and 24 bits depth,
+/// bound while it exists
+class BenchTarget {
+	public:
+		/// @throw an exception if the framebuffer is not complete
+		BenchTarget() {
+			glGenFramebuffers(1, &_fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+			glGenRenderbuffers(2, _renderbuffers);
+			glBindRenderbuffer(GL_RENDERBUFFER, _renderbuffers[0]);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _renderbuffers[0]);
+			glBindRenderbuffer(GL_RENDERBUFFER, _renderbuffers[1]);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _renderbuffers[1]);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+				release();
+				throw std::runtime_error("Error: Could not create the benchmark framebuffer");
+			}
+		}
+		~BenchTarget() {release();}
+		BenchTarget(const BenchTarget& oth) = delete;
+		BenchTarget& operator=(const BenchTarget& oth) = delete;
+
+	private:
+		GLuint	_fbo = 0;
+		GLuint	_renderbuffers[2] = {};	// color, depth
+
+		void release() {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteRenderbuffers(2, _renderbuffers);
+			glDeleteFramebuffers(1, &_fbo);
+			_fbo = _renderbuffers[0] = _renderbuffers[1] = 0;
+		}
+};
+
+/// @brief Utilitary function writing the bound framebuffer to a binary PPM, top row first. Not fatal, the error is reported on std::cerr
+/// @param path .ppm file, overwritten
+static void saveFrame(const std::string& path) {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 3);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out << "P6\n" << SCR_WIDTH << " " << SCR_HEIGHT << "\n255\n";
+	for (unsigned int y = SCR_HEIGHT; y-- > 0;)
+		out.write(reinterpret_cast<const char*>(pixels.data() + y * SCR_WIDTH * 3), SCR_WIDTH * 3);
+	out.close();
+	if (!out)
+		std::cerr << "Error: Could not write benchmark image: " << path << std::endl;
+}
+
+/// @brief Utilitary function: nearest-rank percentile of sorted values
+/// @param sorted values in ascending order, not empty
+/// @param p percentile, in ]0, 100]
+static float percentile(const std::vector<float>& sorted, float p) {
+	size_t rank = static_cast<size_t>(std::ceil(p / 100.f * sorted.size()));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/// @brief Utilitary function: a string as a JSON string literal
+static std::string jsonString(const std::string& str) {
+	std::string out = "\"";
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if (static_cast<unsigned char>(c) < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			out += escaped;
+		}
+		else
+			out += c;
+	}
+	return out + "\"";
+}
+
+/**
+ * @brief --bench mode: render setup.benchFrames frames of a camera orbit around the loaded Model to an offscreen framebuffer,
+ * each one finished (glFinish) before the next, without ImGui nor swap, then print the results as JSON on std::cout: frame
+ * time percentiles, mean CPU / GPU time of the sections (Profiler), GL counters of a frame, load time and peak RSS.
+ *
+ * The orbit only depends on the frame index, so the images saved with --bench-images are the same from one run to the next.
+ * @param shaders variants of the model shader
+ * @param object Model, fully loaded
+ * @param load times of the load of object
+ * @param log out stream for the log messages
+ * @return the exit status of the program
+ * @throw an exception if the framebuffer cannot be created or a shader variant does not build
+ */
+int runBenchmark(ShaderVariants& shaders, Model& object, BenchLoad load, std::ostream& log) {
+	int frames = static_cast<int>(setup.benchFrames);
+	BenchTarget target;
+	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	int imageStep = std::max(1, frames / BENCH_IMAGES);
+	if (!setup.benchImages.empty()) {
+		std::error_code ec;
+		std::filesystem::create_directories(setup.benchImages, ec);
+	}
+
+	// sections of the measured frames, the CPU time of a frame is final once the next one begins, its GPU time one frame later
+	Profiler& profiler = Profiler::instance();
+	double cpuMs[PROFILE_SECTION_COUNT] = {}, gpuMs[PROFILE_SECTION_COUNT] = {};
+	size_t gpuFrames[PROFILE_SECTION_COUNT] = {};
+	auto collect = [&]() {
+		if (profiler.frames() > 0 && profiler.record(0).index >= BENCH_WARMUP_FRAMES)
+			for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+				cpuMs[s] += profiler.record(0).cpuMs[s];
+		if (profiler.frames() > 1 && profiler.record(1).index >= BENCH_WARMUP_FRAMES)
+			for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+				if (profiler.record(1).gpuMs[s] >= 0.f) {
+					gpuMs[s] += profiler.record(1).gpuMs[s];
+					gpuFrames[s]++;
+				}
+	};
+
+	std::vector<float> frameMs;
+	for (int f = 0; f < BENCH_WARMUP_FRAMES + frames; f++) {
+		int measured = f - BENCH_WARMUP_FRAMES;
+		auto start = std::chrono::steady_clock::now();
+		profiler.beginFrame();
+		collect();
+		GLState::instance().beginFrame();
+		camera.orbit(center, BENCH_ORBIT_DISTANCE, measured > 0 ? 360.f * measured / frames : 0.f, BENCH_ORBIT_ELEVATION);
+		{
+			Profiler::Scope scope(PROFILE_MATRICES, true);
+			glClearColor(0.75, 0.75f, 0.6f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			defineMatrices();
+		}
+		{
+			Profiler::Scope scope(PROFILE_DRAW, true);
+			object.Draw(shaders);
+		}
+		{
+			Profiler::Scope scope(PROFILE_SWAP);
+			glFinish();
+		}
+		if (measured < 0)
+			continue;
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		frameMs.push_back(elapsed.count());
+		if (!setup.benchImages.empty() && measured % imageStep == 0 && measured / imageStep < BENCH_IMAGES) {
+			char name[32];
+			snprintf(name, sizeof(name), "frame_%04d.ppm", measured);
+			saveFrame((std::filesystem::path(setup.benchImages) / name).string());
+		}
+	}
+	profiler.beginFrame();
+	collect();
+	const GLCallStats& calls = profiler.record(0).calls;
+
+	std::vector<float> sorted = frameMs;
+	std::sort(sorted.begin(), sorted.end());
+	double total = 0.;
+	for (float ms : frameMs)
+		total += ms;
+	double mean = total / frames;
+	struct rusage usage = {};
+	getrusage(RUSAGE_SELF, &usage);
+	const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+	std::ostream& out = std::cout;
+	out << std::fixed << std::setprecision(3);
+	out << "{\n";
+	out << "\t\"model\": " << jsonString(setup.modelName) << ",\n";
+	out << "\t\"renderer\": " << jsonString(renderer ? renderer : "") << ",\n";
+	out << "\t\"width\": " << SCR_WIDTH << ",\n\t\"height\": " << SCR_HEIGHT << ",\n";
+	out << "\t\"frames\": " << frames << ",\n\t\"warmup_frames\": " << BENCH_WARMUP_FRAMES << ",\n";
+	out << "\t\"load_ms\": " << load.modelMs << ",\n\t\"ready_ms\": " << load.readyMs << ",\n";
+	out << "\t\"frame_ms\": {\"mean\": " << mean << ", \"min\": " << sorted.front() << ", \"p50\": " << percentile(sorted, 50.f)
+		<< ", \"p90\": " << percentile(sorted, 90.f) << ", \"p95\": " << percentile(sorted, 95.f) << ", \"p99\": " << percentile(sorted, 99.f)
+		<< ", \"max\": " << sorted.back() << "},\n";
+	out << "\t\"fps\": " << (mean > 0. ? 1000. / mean : 0.) << ",\n";
+	// mean per measured frame of the sections timed, the GPU one over the frames whose query result was read
+	out << "\t\"sections_ms\": {";
+	bool first = true;
+	for (int s = 0; s < PROFILE_SECTION_COUNT; s++) {
+		if (cpuMs[s] == 0.)
+			continue;
+		out << (first ? "" : ", ") << "\"" << Profiler::name(static_cast<ProfileSection>(s)) << "\": {\"cpu\": " << cpuMs[s] / frames << ", \"gpu\": ";
+		if (gpuFrames[s])
+			out << gpuMs[s] / gpuFrames[s] << "}";
+		else
+			out << "null}";
+		first = false;
+	}
+	out << "},\n";
+	out << "\t\"draws\": " << calls.draws << ",\n\t\"triangles\": " << calls.triangles << ",\n\t\"gl_calls\": " << calls.calls << ",\n";
+	out << "\t\"peak_rss_kb\": " << usage.ru_maxrss << "\n";
+	out << "}" << std::endl;
+
+	log << "Benchmark: " << frames << " frames, " << mean << " ms per frame (p99 " << percentile(sorted, 99.f) << " ms)" << std::endl;
+	return 0;
+}
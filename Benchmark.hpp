@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ShaderVariants.hpp"
+#include <iosfwd>
+
+class Model;
+
+// --bench without a number of frames
+static const unsigned int	BENCH_DEFAULT_FRAMES = 300;
+// --bench: frames rendered before the measured ones (variant compilation, first uploads, driver warm up)
+static const int	BENCH_WARMUP_FRAMES = 10;
+// frames saved by --bench-images, evenly spaced on the orbit
+static const int	BENCH_IMAGES = 8;
+// camera of the orbit, around the normalized model (see setBaseModelMatrix)
+static const float	BENCH_ORBIT_DISTANCE = 3.f;
+static const float	BENCH_ORBIT_ELEVATION = 15.f;
+
+// times of the load of the benchmarked Model, in milliseconds
+struct BenchLoad {
+	double	modelMs;	// Model constructor (parsing or .scopbin, upload of the Meshes)
+	double	readyMs;	// until the last Mesh and texture are on the GPU
+};
+
+int	runBenchmark(ShaderVariants& shaders, Model& object, BenchLoad load, std::ostream& log);
@@ -89,6 +89,19 @@ public:
 		Zoom = ZOOM;
 		updateCameraVectors();
 	}
+    // puts the camera on a circle around target and looks at it: angle around the Y axis from +Z, elevation above the XZ plane, in degrees (angle 0, elevation 0 is the start view)
+    void orbit(vec3 target, float distance, float angle, float elevation)
+    {
+        vec3 offset;
+        offset[0] = cos(radians(elevation)) * sin(radians(angle));
+        offset[1] = sin(radians(elevation));
+        offset[2] = cos(radians(elevation)) * cos(radians(angle));
+        Position = target + offset * distance;
+        Yaw = YAW - angle;
+        Pitch = -elevation;
+        Zoom = ZOOM;
+        updateCameraVectors();
+    }
     // processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
     void ProcessKeyboard(Camera_Movement direction, float deltaTime)
     {
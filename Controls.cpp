@@ -88,49 +88,25 @@ void rotationKey(GLFWwindow *window){
 	bool ctrlDown = glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS
              || glfwGetKey(window, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS;
 		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS){
-				model = 
-				translation(center * -1) *
-				rotation(radians(5), vec3{1,0,0}) *
-				translation(center) *
-				model;
+				model = rotation(radians(5), vec3{1,0,0}, center) * model;
 		}
 		if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS){
-			model = 
-			translation(center * -1) *
-			rotation(radians(-5), vec3{1,0,0}) *
-			translation(center) *
-			model;
+			model = rotation(radians(-5), vec3{1,0,0}, center) * model;
 		}
 	if (!ctrlDown){
 		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS){
-			model = 
-				translation(center * -1) *
-				rotation(radians(5), vec3{0,1,0}) *
-				translation(center) *
-				model;
+			model = rotation(radians(5), vec3{0,1,0}, center) * model;
 		}
 		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS){
-			model = 
-				translation(center * -1) *
-				rotation(radians(-5), vec3{0,1,0}) *
-				translation(center) *
-				model;
+			model = rotation(radians(-5), vec3{0,1,0}, center) * model;
 		}
 	}
 	else {
 		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS){
-			model = 
-			translation(center * -1) *
-			rotation(radians(5), vec3{0,0,1}) *
-			translation(center) *
-			model;
+			model = rotation(radians(5), vec3{0,0,1}, center) * model;
 		}
 		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS){
-			model = 
-			translation(center * -1) *
-			rotation(radians(-5), vec3{0,0,1}) *
-			translation(center) *
-			model;
+			model = rotation(radians(-5), vec3{0,0,1}, center) * model;
 		}
 	}
 }
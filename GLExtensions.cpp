@@ -0,0 +1,42 @@
+#include "GLExtensions.hpp"
+
+#include <cstring>
+
+GLExtensions glExtensions;
+
+/// @brief check if the current context lists an extension
+static bool hasExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++) {
+		const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (ext && strcmp(ext, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+/// @brief read the version of the current context and load the functions above 3.3 it supports. To call once glad is loaded
+/// @param load the loader given to gladLoadGLLoader (glfwGetProcAddress)
+void loadGLExtensions(GLADloadproc load) {
+	glGetIntegerv(GL_MAJOR_VERSION, &glExtensions.major);
+	glGetIntegerv(GL_MINOR_VERSION, &glExtensions.minor);
+	bool gl43 = glExtensions.major > 4 || (glExtensions.major == 4 && glExtensions.minor >= 3);
+
+	// the base instance of the commands is what gives each draw its index (see IndirectDraws)
+	if (gl43 || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance")))
+		glExtensions.MultiDrawElementsIndirect = reinterpret_cast<PFNSCOPMULTIDRAWELEMENTSINDIRECTPROC>(load("glMultiDrawElementsIndirect"));
+	glExtensions.multiDrawIndirect = glExtensions.MultiDrawElementsIndirect != nullptr;
+
+	// program binaries cached on disk (see Shader), useless if the driver has no format to give them in
+	bool gl41 = glExtensions.major > 4 || (glExtensions.major == 4 && glExtensions.minor >= 1);
+	if (gl41 || hasExtension("GL_ARB_get_program_binary")) {
+		glExtensions.GetProgramBinary = reinterpret_cast<PFNSCOPGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+		glExtensions.ProgramBinary = reinterpret_cast<PFNSCOPPROGRAMBINARYPROC>(load("glProgramBinary"));
+		glExtensions.ProgramParameteri = reinterpret_cast<PFNSCOPPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+	}
+	GLint formats = 0;
+	if (glExtensions.GetProgramBinary && glExtensions.ProgramBinary && glExtensions.ProgramParameteri)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	glExtensions.programBinary = formats > 0;
+}
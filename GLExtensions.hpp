@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+# define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+# define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+# define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+# define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP PFNSCOPMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNSCOPGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNSCOPPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNSCOPPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+
+// one draw of glMultiDrawElementsIndirect, layout fixed by the GL
+struct DrawElementsIndirectCommand {
+	GLuint	count;			// number of indices
+	GLuint	instanceCount;
+	GLuint	firstIndex;		// in indices, not bytes
+	GLint	baseVertex;
+	GLuint	baseInstance;
+};
+
+/**
+ * @brief OpenGL features above the 3.3 core profile glad is generated for, loaded at run time by loadGLExtensions.
+ * The window asks for a 3.3 context, most drivers give a newer one: what it has is only known once it is current.
+ */
+struct GLExtensions {
+	int		major = 3;
+	int		minor = 3;
+	bool	multiDrawIndirect = false;	// GL 4.3, or ARB_multi_draw_indirect with ARB_base_instance
+	bool	programBinary = false;		// GL 4.1 or ARB_get_program_binary, with at least one binary format
+	PFNSCOPMULTIDRAWELEMENTSINDIRECTPROC	MultiDrawElementsIndirect = nullptr;
+	PFNSCOPGETPROGRAMBINARYPROC				GetProgramBinary = nullptr;
+	PFNSCOPPROGRAMBINARYPROC				ProgramBinary = nullptr;
+	PFNSCOPPROGRAMPARAMETERIPROC			ProgramParameteri = nullptr;
+};
+
+extern GLExtensions glExtensions;
+
+void	loadGLExtensions(GLADloadproc load);
@@ -0,0 +1,139 @@
+#include "GLState.hpp"
+
+/// @brief the state tracker of the program
+GLState& GLState::instance() {
+	static GLState state;
+	return state;
+}
+
+GLState::GLState() {
+	invalidate();
+}
+
+/// @brief start counting the calls of a new frame, nothing is assumed about the state left by the previous one
+void GLState::beginFrame() {
+	_stats = GLCallStats();
+	invalidate();
+}
+
+/// @brief forget the tracked state: the next call of each kind is issued
+void GLState::invalidate() {
+	_program = UNKNOWN;
+	_vao = UNKNOWN;
+	_polygonMode = UNKNOWN;
+	_lineWidth = -1.f;
+	_activeUnit = -1;
+	for (auto& unit : _textures)
+		unit[0] = unit[1] = UNKNOWN;
+	for (GLuint i = 0; i < UNIFORM_BINDINGS; i++) {
+		_uniformBuffers[i] = UNKNOWN;
+		_uniformOffsets[i] = 0;
+	}
+}
+
+/// @brief calls of the frame so far
+const GLCallStats& GLState::stats() const {return _stats;}
+
+/// @brief count a call, or the call saved when the state is already the one asked for
+/// @return true if the call is to be skipped
+bool GLState::skip(bool same) {
+	if (same)
+		_stats.skipped++;
+	else {
+		_stats.calls++;
+		_stats.stateChanges++;
+	}
+	return same;
+}
+
+void GLState::useProgram(GLuint program) {
+	if (skip(_program == program))
+		return;
+	glUseProgram(program);
+	_program = program;
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+	if (skip(_vao == vao))
+		return;
+	glBindVertexArray(vao);
+	_vao = vao;
+}
+
+/// @brief glPolygonMode of both faces
+void GLState::polygonMode(GLenum mode) {
+	if (skip(_polygonMode == mode))
+		return;
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+	_polygonMode = mode;
+}
+
+void GLState::lineWidth(float width) {
+	if (skip(_lineWidth == width))
+		return;
+	glLineWidth(width);
+	_lineWidth = width;
+}
+
+/// @param unit index of the unit, without GL_TEXTURE0
+void GLState::activeTexture(int unit) {
+	if (skip(_activeUnit == unit))
+		return;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	_activeUnit = unit;
+}
+
+/// @brief bind a texture to a unit, switching the active unit only if the binding changes
+/// @param unit index of the unit, without GL_TEXTURE0
+/// @param target GL_TEXTURE_2D or GL_TEXTURE_BUFFER
+/// @param texture texture name
+void GLState::bindTexture(int unit, GLenum target, GLuint texture) {
+	GLuint* bound = nullptr;
+	if (unit < TEXTURE_UNITS)
+		bound = &_textures[unit][target == GL_TEXTURE_BUFFER];
+	if (bound && skip(*bound == texture))
+		return;
+	activeTexture(unit);
+	glBindTexture(target, texture);
+	if (bound)
+		*bound = texture;
+	else {
+		_stats.calls++;
+		_stats.stateChanges++;
+	}
+}
+
+/// @brief bind a range of a buffer to a uniform block binding point (glBindBufferRange)
+/// @param index binding point
+/// @param buffer buffer name
+/// @param offset in bytes, a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+/// @param size in bytes
+void GLState::bindUniformBuffer(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+	bool tracked = index < UNIFORM_BINDINGS;
+	if (skip(tracked && _uniformBuffers[index] == buffer && _uniformOffsets[index] == offset))
+		return;
+	glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+	if (tracked) {
+		_uniformBuffers[index] = buffer;
+		_uniformOffsets[index] = offset;
+	}
+}
+
+/// @brief count calls that are not tracked (uniforms, buffer updates)
+void GLState::count(size_t calls) {
+	_stats.calls += calls;
+}
+
+/// @brief count a uniform upload (glUniform*, uniform buffer update)
+void GLState::countUniform() {
+	_stats.calls++;
+	_stats.uniforms++;
+}
+
+/// @brief count a draw call
+/// @param triangles triangles it draws
+void GLState::countDraw(size_t triangles) {
+	_stats.calls++;
+	_stats.draws++;
+	_stats.triangles += triangles;
+}
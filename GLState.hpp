@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// GL calls of the drawing code since GLState::beginFrame, to measure what the RenderQueue saves
+struct GLCallStats {
+	size_t	calls = 0;			// every GL call issued, uniforms and their glGetUniformLocation included
+	size_t	draws = 0;			// draw calls among them
+	size_t	triangles = 0;		// triangles of these draws
+	size_t	stateChanges = 0;	// state changes among them (program, VAO, polygon mode, bindings)
+	size_t	uniforms = 0;		// uniform uploads among them (glUniform*, uniform buffer updates)
+	size_t	skipped = 0;		// state changes not issued because the state was already set
+};
+
+/**
+ * @brief the GL state the drawing code changes (program, VAO, polygon mode, line width, texture and uniform buffer bindings), kept on the CPU
+ * so a call setting what is already set is skipped, and the counter of the GL calls of the frame.
+ *
+ * Only what goes through it is tracked: code changing the state behind its back (texture uploads, MeshArena growth, ImGui)
+ * must be followed by invalidate before the next tracked call. GL thread only.
+ */
+class GLState {
+	public:
+		static GLState& instance();
+
+		void	beginFrame();
+		void	invalidate();
+		const GLCallStats&	stats() const;
+
+		void	useProgram(GLuint program);
+		void	bindVertexArray(GLuint vao);
+		void	polygonMode(GLenum mode);
+		void	lineWidth(float width);
+		void	activeTexture(int unit);
+		void	bindTexture(int unit, GLenum target, GLuint texture);
+		void	bindUniformBuffer(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+		void	count(size_t calls = 1);
+		void	countUniform();
+		void	countDraw(size_t triangles);
+
+	private:
+		static const int	TEXTURE_UNITS = 8;
+		static const GLuint	UNIFORM_BINDINGS = 4;
+		static const GLuint	UNKNOWN = ~0u;
+
+		GLCallStats	_stats;
+		GLuint		_program = UNKNOWN;
+		GLuint		_vao = UNKNOWN;
+		GLenum		_polygonMode = UNKNOWN;
+		float		_lineWidth = -1.f;
+		int			_activeUnit = -1;
+		GLuint		_textures[TEXTURE_UNITS][2];	// GL_TEXTURE_2D, GL_TEXTURE_BUFFER
+		GLuint		_uniformBuffers[UNIFORM_BINDINGS];
+		GLintptr	_uniformOffsets[UNIFORM_BINDINGS];
+
+		GLState();
+		bool	skip(bool same);
+};
@@ -6,11 +6,13 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include <vml.hpp>
 
 //utils.cpp
 void strTrim(std::string& str, std::string arr = " \t\r\n");
 std::string fileToStr(const std::string& filePath);
+bool fileStamp(const std::string& path, int64_t& size, int64_t& mtime);
 
 
 #include "../Texture.hpp"
@@ -40,8 +42,8 @@ extern vml::vec3 center;
 #include "../Shader.hpp"
 #include "../Camera.hpp"
 //modelMatrices.cpp
-void setBaseModelMatrix(GLFWwindow *window, Model& object);
-void defineMatrices(Shader& shad);
+void setBaseModelMatrix(GLFWwindow *window, Model& object, bool resetCamera = true);
+void defineMatrices();
 
 //controls.cpp
 void scaleAndResetKey(GLFWwindow *window, Model& object);
@@ -55,6 +57,6 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void setup_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 //window.cpp
-GLFWwindow* initWindow(std::string name);
+GLFWwindow* initWindow(std::string name, bool hidden = false);
 void initImgui(GLFWwindow* window);
-void createUIImgui();
+void createUIImgui(Model& object);
@@ -2,6 +2,7 @@
 
 #include "../Texture.hpp"
 #include "vml.hpp"
+#include <cstdint>
 
 using namespace vml;
 
@@ -10,11 +11,24 @@ enum view {
 	perspect
 };
 
+// .obj parsing strategy (--loader=stream|mmap)
+enum loadMode {
+	streamed,	// std::getline + one std::stringstream per line
+	mapped		// mmap of the file + std::from_chars over the bytes
+};
+
 struct Vertex {
     vec3 Position;		//v
     vec3 Normal;		//vn
     vec2 TexCoords;	//vt
-	int triID;
+};
+
+// GPU layout of a Vertex with --packed-vertices (see Mesh::packVertices), decoded by the vertex shader
+struct PackedVertex {
+	uint16_t	position[3];	// unorm16 inside the mesh AABB
+	uint16_t	pad;
+	uint16_t	normal[2];		// unorm16 octahedral encoding
+	uint16_t	texCoords[2];	// half floats
 };
 
 struct Material {
@@ -32,6 +46,8 @@ struct Material {
     Texture diffuseTex;
     Texture specularTex;
     Texture normalTex;
+
+    size_t tableIndex = 0; // row of the Material in the MaterialTable of its Model
 };
 
 struct Setup {
@@ -42,6 +58,22 @@ struct Setup {
 	bool showColors = false;
 	bool showPoints = false;
 	std::string		modelName;
+	loadMode		loader = mapped;
+	unsigned int	loaderThreads = 0;	// mmap loader and normal / UV generation threads, 0 = one per hardware thread, 1 = serial
+	bool			useCache = true;	// read/write the .scopbin cache of the model
+	std::string		cacheDir;			// where to put the .scopbin and .scopprog, next to the .obj / shaders if empty
+	bool			shaderCache = true;	// read/write the .scopprog program binaries of the shaders
+	bool			progressiveLoad = false;	// parse the .obj on a worker thread and draw the Meshes as they come
+	bool			pboUploads = true;	// upload the textures through pixel buffer objects
+	bool			cpuMipmaps = true;	// build the texture mip chains on the decoding workers instead of glGenerateMipmap
+	bool			textureContainers = true;	// load the textures from their up to date .scoptex when there is one
+	bool			optimizeMeshes = true;	// reorder triangles and vertices for the vertex cache and overdraw (MeshOptimize.hpp)
+	bool			packedVertices = false;	// upload the vertices as PackedVertex instead of Vertex
+	bool			indirectDraw = false;	// submit all the Meshes of the Model at once (IndirectDraws) instead of one by one
+	bool			convertTextures = false;	// only write the .scoptex of the images given in parameter, no window
+	std::string		profileCsv = "scop_profile.csv";	// where the profiler panel dumps its frames (Profiler::dumpCsv)
+	unsigned int	benchFrames = 0;	// --bench: frames to render offscreen and measure instead of opening the window, 0 = no benchmark
+	std::string		benchImages;		// --bench: where to save frames of the orbit as .ppm, none if empty
 
 	Texture custom;
 
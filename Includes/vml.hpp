@@ -2,6 +2,13 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstddef>
+#include <type_traits>
+#if defined(__AVX__)
+# include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64)
+# include <xmmintrin.h>
+#endif
 
 
 //stand for Vectors and Matrices Library
@@ -164,7 +171,7 @@ namespace vml {
 		}
 
 		// other operations
-		T dot(Vector<T,N> vec) const {
+		T dot(const Vector<T,N>& vec) const {
 			T res = T{};
 			for (size_t i = 0; i < N; i++)
 				res += data[i] * vec[i];
@@ -198,6 +205,159 @@ namespace vml {
 	using vec3 = Vector<float, 3>;
 	using vec4 = Vector<float, 4>;
 
+	static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 arrays are read as packed floats");
+
+	/**
+	 * @brief SSE (AVX when the build enables it) kernels of the float mat4 and vec3 operations, scalar loops elsewhere.
+	 *
+	 * Each one does the same float operations in the same order as the generic templates, sums starting from 0 included,
+	 * so the results are the same bit for bit whatever the path (no FMA: it would round once instead of twice).
+	 */
+	namespace simd {
+#if defined(__SSE__) || defined(_M_X64)
+		/// @brief transpose 4 packed vec3 (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) to their x, y and z lanes
+		inline void loadVec3x4(const float* p, __m128& x, __m128& y, __m128& z) {
+			__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+			x = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 1, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+			y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		}
+		/// @brief inverse of loadVec3x4
+		inline void storeVec3x4(float* p, __m128 x, __m128 y, __m128 z) {
+			__m128 a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+			__m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			_mm_storeu_ps(p, a);
+			_mm_storeu_ps(p + 4, b);
+			_mm_storeu_ps(p + 8, c);
+		}
+		/// @brief x*x' + y*y' + z*z' of 4 vec3 at once, from 0 like dot
+		inline __m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+			__m128 res = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(ax, bx));
+			res = _mm_add_ps(res, _mm_mul_ps(ay, by));
+			return _mm_add_ps(res, _mm_mul_ps(az, bz));
+		}
+#endif
+
+		/// @brief out = a * b for row-major 4x4 float matrices, out must not be a or b
+		inline void mat4Mul(const float* a, const float* b, float* out) {
+#if defined(__AVX__)
+			// two rows of out per iteration, each half of the register its own row
+			__m256 rows[4];
+			for (int c = 0; c < 4; c++)
+				rows[c] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + c * 4));
+			for (int r = 0; r < 4; r += 2) {
+				__m256 res = _mm256_setzero_ps();
+				for (int c = 0; c < 4; c++)
+					res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_setr_m128(_mm_set1_ps(a[r * 4 + c]), _mm_set1_ps(a[(r + 1) * 4 + c])), rows[c]));
+				_mm256_storeu_ps(out + r * 4, res);
+			}
+#elif defined(__SSE__) || defined(_M_X64)
+			__m128 rows[4];
+			for (int c = 0; c < 4; c++)
+				rows[c] = _mm_loadu_ps(b + c * 4);
+			for (int r = 0; r < 4; r++) {
+				__m128 res = _mm_setzero_ps();
+				for (int c = 0; c < 4; c++)
+					res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(a[r * 4 + c]), rows[c]));
+				_mm_storeu_ps(out + r * 4, res);
+			}
+#else
+			for (int r = 0; r < 4; r++)
+				for (int c2 = 0; c2 < 4; c2++) {
+					float res = 0.f;
+					for (int c = 0; c < 4; c++)
+						res += a[r * 4 + c] * b[c * 4 + c2];
+					out[r * 4 + c2] = res;
+				}
+#endif
+		}
+
+		/// @brief out = m * v for a row-major 4x4 float matrix, out must not be v
+		inline void mat4MulVec4(const float* m, const float* v, float* out) {
+#if defined(__SSE__) || defined(_M_X64)
+			// columns of m, scaled by each coordinate and summed in the order of the rows dot products
+			__m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			__m128 res = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(_mm_set1_ps(v[0]), c0));
+			res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(v[1]), c1));
+			res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(v[2]), c2));
+			res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(v[3]), c3));
+			_mm_storeu_ps(out, res);
+#else
+			for (int r = 0; r < 4; r++) {
+				float res = 0.f;
+				for (int c = 0; c < 4; c++)
+					res += v[c] * m[r * 4 + c];
+				out[r] = res;
+			}
+#endif
+		}
+	}
+
+	/**
+	 * @brief dot products of count pairs of vec3: out[i] = dot(a[i], b[i])
+	 * @param a first vectors
+	 * @param b second vectors
+	 * @param out count results, may not alias a or b
+	 * @param count number of pairs
+	 */
+	inline void dot(const vec3* a, const vec3* b, float* out, size_t count) {
+		size_t i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		for (; i + 4 <= count; i += 4) {
+			__m128 ax, ay, az, bx, by, bz;
+			simd::loadVec3x4(a[i].data, ax, ay, az);
+			simd::loadVec3x4(b[i].data, bx, by, bz);
+			_mm_storeu_ps(out + i, simd::dot3(ax, ay, az, bx, by, bz));
+		}
+#endif
+		for (; i < count; i++)
+			out[i] = a[i].dot(b[i]);
+	}
+	/**
+	 * @brief cross products of count pairs of vec3: out[i] = cross(a[i], b[i])
+	 * @param a first vectors
+	 * @param b second vectors
+	 * @param out count results, may be a or b
+	 * @param count number of pairs
+	 */
+	inline void cross(const vec3* a, const vec3* b, vec3* out, size_t count) {
+		size_t i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		for (; i + 4 <= count; i += 4) {
+			__m128 ax, ay, az, bx, by, bz;
+			simd::loadVec3x4(a[i].data, ax, ay, az);
+			simd::loadVec3x4(b[i].data, bx, by, bz);
+			simd::storeVec3x4(out[i].data,
+				_mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)),
+				_mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)),
+				_mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+		}
+#endif
+		for (; i < count; i++)
+			out[i] = a[i].cross(b[i]);
+	}
+	/**
+	 * @brief normalize count vec3: out[i] = in[i].normalize()
+	 * @param in vectors to normalize
+	 * @param out count results, may be in
+	 * @param count number of vectors
+	 */
+	inline void normalize(const vec3* in, vec3* out, size_t count) {
+		size_t i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		for (; i + 4 <= count; i += 4) {
+			__m128 x, y, z;
+			simd::loadVec3x4(in[i].data, x, y, z);
+			__m128 len = _mm_sqrt_ps(simd::dot3(x, y, z, x, y, z));
+			simd::storeVec3x4(out[i].data, _mm_div_ps(x, len), _mm_div_ps(y, len), _mm_div_ps(z, len));
+		}
+#endif
+		for (; i < count; i++)
+			out[i] = in[i].normalize();
+	}
+
 	/**
 	 * @brief Matrix Template Structure of row column order with operators, other operation function and graph matrices needed for 3D manipulation
 	 * 
@@ -256,8 +416,12 @@ namespace vml {
 			return *this;
 		}
 		template<size_t C2>
-		Matrix<T, R, C2> operator*(Matrix<T, C, C2> mat) {
+		Matrix<T, R, C2> operator*(const Matrix<T, C, C2>& mat) const {
 			Matrix<T, R, C2> res{};
+			if constexpr (std::is_same_v<T, float> && R == 4 && C == 4 && C2 == 4) {
+				simd::mat4Mul(data, mat.data, res.data);
+				return res;
+			}
 			for (size_t r = 0; r < R; r++){
 				for (size_t c2 = 0; c2 < C2; c2++){
 					for (size_t c = 0; c < C; c++){
@@ -268,15 +432,19 @@ namespace vml {
 			return res;
 		}
 		template<size_t C2>
-		Matrix<T, R, C2> operator*=(Matrix<T, C, C2> mat) {
+		Matrix<T, R, C2> operator*=(const Matrix<T, C, C2>& mat) {
 			static_assert(R == C, "For *= operation Matrix need to be square.");
 			*this = (*this) * mat;
 			return *this;
 		}
 		template<size_t C2>
-		Vector<T, R> operator*(Vector<T, C2> vec) {
+		Vector<T, R> operator*(const Vector<T, C2>& vec) const {
 			static_assert(C == C2, "Matrix and vector sizes incompatible.");
 			Vector<T, R> res;
+			if constexpr (std::is_same_v<T, float> && R == 4 && C == 4) {
+				simd::mat4MulVec4(data, vec.data, res.data);
+				return res;
+			}
 			for (size_t r = 0; r < R; r++)
 				for (size_t c = 0; c < C2; c++)
 					res[r] += vec[c] * (*this)[r][c];
@@ -328,7 +496,7 @@ namespace vml {
 	 * 
 	 * @return a vec3 the cross product
 	*/
-	inline vec3 cross(vec3 v1, vec3 v2) {
+	inline vec3 cross(const vec3& v1, const vec3& v2) {
 		return vec3{
 			v1[1] * v2[2] - v1[2] * v2[1],
 			v1[2] * v2[0] - v1[0] * v2[2],
@@ -343,7 +511,7 @@ namespace vml {
 	 * @return the dot product of T type
 	*/
 	template<typename T, size_t N>
-	T dot(Vector<T, N> v1, Vector<T, N> v2) {
+	T dot(const Vector<T, N>& v1, const Vector<T, N>& v2) {
 		T res = T{};
 		for (size_t i = 0; i < N; i++)
 			res += v1[i] * v2[i];
@@ -357,7 +525,7 @@ namespace vml {
 	 * @return a new normalized vector from the original
 	 */
 	template<typename T, size_t N>
-	inline Vector<T, N> normalize(Vector<T, N> vec) {
+	inline Vector<T, N> normalize(const Vector<T, N>& vec) {
 		T len = vec.norm();
 		Vector<T, N> res;
 		for (size_t i = 0; i < N; i++)
@@ -412,6 +580,23 @@ namespace vml {
 			0.f,           0.f,           0.f,           1.f
 		});
 	}
+	/**
+	 * @brief translation(offset * -1) * rotation(rad, axis) * translation(offset) built in one go: the rotation around the
+	 * point -offset, for the price of a single matrix product (R * offset) instead of two full mat4 products
+	 *
+	 * @param rad	a float value that is the radian of the angle of rotation desired
+	 * @param axis	a vec3 precising on which axis you want the rotation to be
+	 * @param offset	the translation applied before the rotation and undone after it
+	 *
+	 * @return a mat4 to apply on another mat4
+	 */
+	inline mat4 rotation(float rad, vec3 axis, vec3 offset) {
+		mat4 res = rotation(rad, axis);
+		vec4 moved = res * vec4{offset[0], offset[1], offset[2], 1.f};
+		for (int i = 0; i < 3; i++)
+			res[i][3] = moved[i] - offset[i];
+		return res;
+	}
 	/**
 	 * @brief Builds a LookAt view matrix that transforms world space into camera space.
 	 * @param eye     The camera position.
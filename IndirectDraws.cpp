@@ -0,0 +1,173 @@
+#include "IndirectDraws.hpp"
+#include "Mesh.hpp"
+#include "GLState.hpp"
+#include "UniformBuffers.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+/// @brief default constructor, the buffers are created by build
+IndirectDraws::IndirectDraws() {}
+
+/// @brief delete the buffers and the table texture
+IndirectDraws::~IndirectDraws() {
+	if (_commandBuffer)
+		glDeleteBuffers(1, &_commandBuffer);
+	if (_drawIdBuffer)
+		glDeleteBuffers(1, &_drawIdBuffer);
+	if (_tableBuffer)
+		glDeleteBuffers(1, &_tableBuffer);
+	if (_tableTexture)
+		glDeleteTextures(1, &_tableTexture);
+}
+
+/**
+ * @brief (re)build the commands, batches and per-draw table of the uploaded Meshes, to call again whenever a Mesh is added
+ * or a Material texture changes. Sets the aDrawID attribute of the arena VAO and leaves no VAO bound.
+ * @param meshes Meshes of the Model, all in arena
+ * @param materials Materials of the Model, by name, each with its row in the MaterialTable of the Model
+ * @param arena buffers the Meshes were uploaded to
+ * @return false if the table does not fit in a texture buffer (GL_MAX_TEXTURE_BUFFER_SIZE), the Meshes must then be drawn one by one
+ */
+bool IndirectDraws::build(std::vector<Mesh>& meshes, std::unordered_map<std::string, Material>& materials, MeshArena& arena) {
+	struct Draw {
+		unsigned	maps;			// textures the Material has, what picks its shader variant
+		size_t		page;			// of the MaterialTable row of the Material
+		GLenum		indexType;
+		int			textures[3];	// diffuse, specular, normal
+		Material*	material;
+		Mesh*		mesh;
+	};
+	std::vector<Draw> draws;
+	draws.reserve(meshes.size());
+	for (auto& mesh : meshes) {
+		if (!mesh.indexCount())
+			continue;
+		Material& mat = materials[mesh.materialName()];
+		unsigned maps = (mat.diffuseTex.id() != 0) | (mat.specularTex.id() != 0) << 1 | (mat.normalTex.id() != 0) << 2;
+		draws.push_back({maps, mat.tableIndex / MATERIAL_TABLE_SIZE, mesh.indexType(), {mat.diffuseTex.id(), mat.specularTex.id(), mat.normalTex.id()}, &mat, &mesh});
+	}
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if (draws.size() * DRAW_TABLE_TEXELS > static_cast<size_t>(maxTexels))
+		return false;
+
+	// Meshes keep their order inside a batch
+	auto key = [](const Draw& d) { return std::make_tuple(d.maps, d.page, d.indexType, d.textures[0], d.textures[1], d.textures[2]); };
+	std::stable_sort(draws.begin(), draws.end(), [&](const Draw& a, const Draw& b) { return key(a) < key(b); });
+
+	_commands.clear();
+	_batches.clear();
+	std::vector<float> table;
+	table.reserve(draws.size() * DRAW_TABLE_TEXELS * 4);
+	for (size_t i = 0; i < draws.size(); i++) {
+		Draw& d = draws[i];
+		Mesh& mesh = *d.mesh;
+		size_t indexSize = d.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+		_commands.push_back({static_cast<GLuint>(mesh.indexCount()), 1, static_cast<GLuint>(mesh.range().indexOffset / indexSize),
+			mesh.range().baseVertex, static_cast<GLuint>(i)});
+		if (_batches.empty() || key(draws[_batches.back().first]) != key(d))
+			_batches.push_back({d.indexType, d.material, d.page, i, 0, 0});
+		_batches.back().count++;
+		_batches.back().triangles += mesh.indexCount() / 3;
+
+		// same values as the uniforms of Mesh::Draw, read back by texelFetch in the vertex shader
+		vec3 posMin = mesh.posMin();
+		vec3 posScale = mesh.posScale();
+		float row[DRAW_TABLE_TEXELS * 4] = {
+			posMin[0], posMin[1], posMin[2], static_cast<float>(d.material->tableIndex % MATERIAL_TABLE_SIZE),
+			posScale[0], posScale[1], posScale[2], 0,
+		};
+		table.insert(table.end(), row, row + DRAW_TABLE_TEXELS * 4);
+	}
+
+	if (!_tableBuffer) {
+		glGenBuffers(1, &_tableBuffer);
+		glGenTextures(1, &_tableTexture);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, _tableBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, table.size() * sizeof(float), table.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE0 + DRAW_TABLE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, _tableTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, _tableBuffer);
+	glActiveTexture(GL_TEXTURE0);
+
+	_packed = arena.packed();
+	glBindVertexArray(arena.VAO());
+	if (glExtensions.multiDrawIndirect) {
+		if (!_commandBuffer) {
+			glGenBuffers(1, &_commandBuffer);
+			glGenBuffers(1, &_drawIdBuffer);
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, _commands.size() * sizeof(DrawElementsIndirectCommand), _commands.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+		// one value per instance: the base instance of a command picks its draw index
+		std::vector<GLuint> ids(draws.size());
+		for (size_t i = 0; i < ids.size(); i++)
+			ids[i] = static_cast<GLuint>(i);
+		glBindBuffer(GL_ARRAY_BUFFER, _drawIdBuffer);
+		glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(GLuint), ids.data(), GL_STATIC_DRAW);
+		glVertexAttribIPointer(DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+		glVertexAttribDivisor(DRAW_ID_LOCATION, 1);
+		glEnableVertexAttribArray(DRAW_ID_LOCATION);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else	// current value of the attribute, set before each draw
+		glDisableVertexAttribArray(DRAW_ID_LOCATION);
+	glBindVertexArray(0);
+	return true;
+}
+
+/// @brief submit every command, one glMultiDrawElementsIndirect per batch (one glDrawElementsBaseVertex per command on 3.3),
+/// with the shader variant of the textures of the batch. The arena VAO must be bound
+/// @param shaders variants of the model shader
+/// @param table MaterialTable the Materials given to build have their row in, a page bound per batch
+void IndirectDraws::draw(ShaderVariants& shaders, const MaterialTable& table) {
+	GLState& gl = GLState::instance();
+	gl.bindTexture(DRAW_TABLE_UNIT, GL_TEXTURE_BUFFER, _tableTexture);
+	if (glExtensions.multiDrawIndirect) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+		gl.count();
+	}
+
+	Shader* shader = nullptr;
+	for (auto& batch : _batches) {
+		Shader& variant = shaders.get(*batch.material);
+		if (&variant != shader) {
+			shader = &variant;
+			Mesh::setDrawState(*shader);
+			shader->set(shader->uniforms.packedVertex, _packed);
+			shader->set(shader->uniforms.indirectDraw, true);
+		}
+		table.bindPage(batch.page);
+		Mesh::bindTextures(*batch.material);
+		if (glExtensions.multiDrawIndirect) {
+			glExtensions.MultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+				reinterpret_cast<const void*>(batch.first * sizeof(DrawElementsIndirectCommand)), static_cast<GLsizei>(batch.count), 0);
+			gl.countDraw(batch.triangles);
+			continue;
+		}
+		size_t indexSize = batch.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+		for (size_t i = batch.first; i < batch.first + batch.count; i++) {
+			const DrawElementsIndirectCommand& cmd = _commands[i];
+			glVertexAttribI1ui(DRAW_ID_LOCATION, cmd.baseInstance);
+			glDrawElementsBaseVertex(GL_TRIANGLES, cmd.count, batch.indexType,
+				reinterpret_cast<const void*>(cmd.firstIndex * indexSize), cmd.baseVertex);
+			gl.count();
+			gl.countDraw(cmd.count / 3);
+		}
+	}
+
+	if (glExtensions.multiDrawIndirect) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		gl.count();
+	}
+	gl.activeTexture(0);
+}
+
+//getters
+size_t IndirectDraws::draws() const {return _commands.size();}
+size_t IndirectDraws::batches() const {return _batches.size();}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GLExtensions.hpp"
+#include "ShaderVariants.hpp"
+#include "Includes/struct.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class MeshArena;
+class MaterialTable;
+
+static const GLuint	DRAW_ID_LOCATION = 5;	// vertex attribute of the draw index (aDrawID)
+static const int	DRAW_TABLE_UNIT = 4;	// texture unit of the per-draw table (drawTable)
+static const int	DRAW_TABLE_TEXELS = 2;	// RGBA32F texels per draw in the table
+
+// consecutive commands sharing their MaterialTable page, index type and textures, submitted by one glMultiDrawElementsIndirect
+struct DrawBatch {
+	GLenum		indexType;
+	Material*	material;	// any of the Materials of the batch, for its textures
+	size_t		page;		// MaterialTable page holding the rows of its Materials
+	size_t		first;		// first command
+	size_t		count;
+	size_t		triangles;	// of all its commands
+};
+
+/**
+ * @brief every Mesh of a Model as one list of DrawElementsIndirectCommand, built once and submitted with
+ * glMultiDrawElementsIndirect: a few calls per frame whatever the number of Meshes.
+ *
+ * The commands are sorted by shader variant (the textures a Material has), MaterialTable page, index type and textures,
+ * the only state that still changes between them. What the Mesh
+ * uniforms gave (MaterialTable row, packed AABB) is in a table indexed by the draw: a texture buffer read by the shaders.
+ * Each draw finds its row through aDrawID, an instanced attribute of the MeshArena VAO that the base instance of its
+ * command selects. When the context has no glMultiDrawElementsIndirect (3.3), the same commands are drawn one by one
+ * with glDrawElementsBaseVertex, aDrawID then being set by glVertexAttribI1ui. GL thread only.
+ */
+class IndirectDraws {
+	public:
+		IndirectDraws();
+		IndirectDraws(const IndirectDraws& oth) = delete;
+		IndirectDraws& operator=(const IndirectDraws& oth) = delete;
+		~IndirectDraws();
+
+		bool	build(std::vector<Mesh>& meshes, std::unordered_map<std::string, Material>& materials, MeshArena& arena);
+		void	draw(ShaderVariants& shaders, const MaterialTable& table);
+
+		//getters
+		size_t	draws() const;
+		size_t	batches() const;
+
+	private:
+		std::vector<DrawElementsIndirectCommand>	_commands;
+		std::vector<DrawBatch>						_batches;
+		GLuint	_commandBuffer = 0;	// GL_DRAW_INDIRECT_BUFFER
+		GLuint	_drawIdBuffer = 0;	// 0, 1, 2... read through the base instance
+		GLuint	_tableBuffer = 0;
+		GLuint	_tableTexture = 0;
+		bool	_packed = false;	// the arena vertices are PackedVertex
+};
@@ -0,0 +1,66 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// @brief default constructor, nothing mapped
+MappedFile::MappedFile() : _fd(-1), _data(nullptr), _size(0) {}
+
+/// @brief map the file given in parameter
+/// @param path file to map
+/// @throw an exception if the file could not be opened or mapped
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+	open(path);
+}
+
+/// @brief unmap and close the file
+MappedFile::~MappedFile() {
+	close();
+}
+
+/// @brief open and map the whole file read-only. An empty file is valid and gives a null data pointer with a size of 0
+/// @param path file to map
+/// @throw an exception if the file could not be opened or mapped
+void MappedFile::open(const std::string& path) {
+	close();
+	_fd = ::open(path.c_str(), O_RDONLY);
+	if (_fd < 0)
+		throw std::runtime_error("Error: File could not be opened or does not exist: " + path);
+
+	struct stat st;
+	if (fstat(_fd, &st) < 0) {
+		close();
+		throw std::runtime_error("Error: Could not stat file: " + path);
+	}
+	_size = static_cast<size_t>(st.st_size);
+	if (_size == 0)
+		return;
+
+	void* addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+	if (addr == MAP_FAILED) {
+		close();
+		throw std::runtime_error("Error: Could not map file: " + path);
+	}
+	// the parsers read front to back, let the kernel read ahead aggressively
+	madvise(addr, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(addr);
+}
+
+/// @brief release the mapping and the file descriptor if any
+void MappedFile::close() {
+	if (_data)
+		munmap(const_cast<char*>(_data), _size);
+	if (_fd >= 0)
+		::close(_fd);
+	_fd = -1;
+	_data = nullptr;
+	_size = 0;
+}
+
+//getters
+const char* MappedFile::data() const {return _data;}
+size_t MappedFile::size() const {return _size;}
+bool MappedFile::isOpen() const {return _fd >= 0;}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Read-only memory mapping of a whole file (RAII). The mapping is released with the object.
+ *
+ * Used by the loaders to walk the file bytes in place instead of copying them line by line.
+ */
+class MappedFile {
+	public:
+		MappedFile();
+		MappedFile(const std::string& path);
+		MappedFile(const MappedFile& oth) = delete;
+		MappedFile& operator=(const MappedFile& oth) = delete;
+		~MappedFile();
+
+		void open(const std::string& path);
+		void close();
+
+		//getters
+		const char*	data() const;
+		size_t		size() const;
+		bool		isOpen() const;
+
+	private:
+		int			_fd;
+		const char*	_data;
+		size_t		_size;
+};
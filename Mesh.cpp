@@ -1,17 +1,25 @@
 #include "Mesh.hpp"
+#include "GLState.hpp"
 
-//default constructor set value to 0 for protection
-Mesh::Mesh() {_VAO = _VBO = _EBO = 0;}
+#include <cstring>
+
+//default constructor
+Mesh::Mesh() {}
 
 //copy constructor
 Mesh::Mesh(const Mesh& oth)
 	: _name(oth._name),
 	_vertices(oth._vertices),
 	_indices(oth._indices),
-	_materialName(oth._materialName) {
-	_VAO = oth._VAO;
-	_VBO = oth._VBO;
-	_EBO = oth._EBO;
+	_materialName(oth._materialName),
+	_cacheBefore(oth._cacheBefore),
+	_cacheAfter(oth._cacheAfter) {
+	_arena = oth._arena;
+	_range = oth._range;
+	_indexCount = oth._indexCount;
+	_indexType = oth._indexType;
+	_posMin = oth._posMin;
+	_posScale = oth._posScale;
 	_vnPresent = oth._vnPresent;
 	_vtPresent = oth._vtPresent;
 }
@@ -22,124 +30,246 @@ Mesh& Mesh::operator=(const Mesh& oth) {
 		_name = oth._name;
 		_vertices = oth._vertices;
 		_indices = oth._indices;
+		_arena = oth._arena;
+		_range = oth._range;
+		_indexCount = oth._indexCount;
+		_indexType = oth._indexType;
+		_posMin = oth._posMin;
+		_posScale = oth._posScale;
+		_vnPresent = oth._vnPresent;
+		_vtPresent = oth._vtPresent;
 		_materialName = oth._materialName;
+		_cacheBefore = oth._cacheBefore;
+		_cacheAfter = oth._cacheAfter;
 	}
 	return *this;
 }
 
-/// @brief draw function that check viewmode to adapt, set textures and other values and send it to the shader (fragment shader mostly)
-/// @param shader program shader linked to the model
+/// @brief draw function that check viewmode to adapt, set textures and other values and send it to the shader (fragment shader mostly).
+/// Sets everything for this Mesh alone, the RenderQueue of Model::Draw only sets what changes between Meshes
+/// @param shader variant of the model shader for material and the view mode (ShaderVariants::get)
 /// @param material structure linked to the Mesh that contain the details from the mtl
-void Mesh::Draw(Shader &shader, Material material) {
+/// @param table MaterialTable of the Model, holding the colours of material
+void Mesh::Draw(Shader &shader, Material material, const MaterialTable &table) {
+	setDrawState(shader);
+	bindTextures(material);
+	table.use(shader, material);
+
+	// vertex layout
+	GLState::instance().bindVertexArray(VAO());
+	shader.set(shader.uniforms.packedVertex, packed());
+	setLayout(shader);
+
+	drawElements();
+	GLState::instance().activeTexture(0);
+}
+
+/// @brief the part of the drawing state that does not depend on the Mesh: polygon mode, custom texture and model matrix.
+/// The camera and light are in the Frame block (FrameUniforms, written by defineMatrices), the texture units and view mode
+/// are fixed in the variant (ShaderVariants)
+/// @param shader variant of the model shader
+void Mesh::setDrawState(Shader &shader) {
+	GLState& gl = GLState::instance();
 	shader.use();
-	glBindVertexArray(_VAO);
 	if (setup.showLines){
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		glLineWidth(0.1f);
+		gl.polygonMode(GL_LINE);
+		gl.lineWidth(0.1f);
 	}
 	else if (setup.showPoints){
-		glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-		glLineWidth(1.f);
+		gl.polygonMode(GL_POINT);
+		gl.lineWidth(1.f);
 	}
 	else
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		gl.polygonMode(GL_FILL);
 
-	// custom or diffuse
-	if (setup.applyCustomTexture && setup.custom.id()){
-		glActiveTexture(GL_TEXTURE0);
-		shader.setInt("customTex", 0);
-		glBindTexture(GL_TEXTURE_2D,setup.custom.id());
-	}
-	else if (material.diffuseTex.id() != 0) {
-		glActiveTexture(GL_TEXTURE1);
-		shader.setInt("material.diffuse", 1);
-		glBindTexture(GL_TEXTURE_2D, material.diffuseTex.id());
-	}
+	// custom
+	if (setup.applyCustomTexture && setup.custom.id())
+		gl.bindTexture(0, GL_TEXTURE_2D, setup.custom.id());
 
-	// specular
-	if (material.specularTex.id() != 0) {
-		glActiveTexture(GL_TEXTURE2);
-		shader.setInt("material.specular", 2);
-		glBindTexture(GL_TEXTURE_2D, material.specularTex.id());
-	}
+	shader.set(shader.uniforms.model, model);
+	shader.set(shader.uniforms.indirectDraw, false);
+}
 
-	// normal
-	if (material.normalTex.id() != 0) {
-		glActiveTexture(GL_TEXTURE3);
-		shader.setInt("material.normalMap", 3);
-		glBindTexture(GL_TEXTURE_2D, material.normalTex.id());
-	}
+/// @brief bind the diffuse (unless the custom texture replaces it), specular and normal textures of a Material
+/// @param material Material of the Mesh(es) about to be drawn
+void Mesh::bindTextures(Material &material) {
+	GLState& gl = GLState::instance();
+	if (!(setup.applyCustomTexture && setup.custom.id()) && material.diffuseTex.id() != 0)
+		gl.bindTexture(1, GL_TEXTURE_2D, material.diffuseTex.id());
+	if (material.specularTex.id() != 0)
+		gl.bindTexture(2, GL_TEXTURE_2D, material.specularTex.id());
+	if (material.normalTex.id() != 0)
+		gl.bindTexture(3, GL_TEXTURE_2D, material.normalTex.id());
+}
+
+/// @brief send the packed AABB of the Mesh to the shader (identity for float vertices)
+/// @param shader program shader linked to the model
+void Mesh::setLayout(Shader &shader) {
+	shader.set(shader.uniforms.posMin, _posMin);
+	shader.set(shader.uniforms.posScale, _posScale);
+}
 
-	// booleans
-	shader.setBool("showFaces", setup.showFaces);
-	shader.setBool("changeColor", setup.showColors);
-	shader.setBool("useCustomTex", setup.applyCustomTexture && setup.custom.id() != 0);
-	shader.setBool("useDiffuseMap",  material.diffuseTex.id()  != 0);
-	shader.setBool("useSpecularMap", material.specularTex.id() != 0);
-	shader.setBool("useNormalMap",   material.normalTex.id()   != 0);
-
-	// scalar uniforms
-	shader.setVec3("material.ambient",        material.ambient);
-	shader.setVec3("material.diffuseColor",   material.diffuse);
-	shader.setVec3("material.specularColor",  material.specular);
-	shader.setFloat("material.shininess",     material.shininess);
-	shader.setFloat("material.opacity",       material.opacity);
-
-	// light
-	shader.setVec3("lightPos", setup.lightPos);
-	shader.setVec3("lightColor", setup.lightColor);
-	shader.setVec3("viewPos", setup.viewPos);
-
-	glBindVertexArray(_VAO);
-	// draw
-	glDrawElements(GL_TRIANGLES, _indices.size(), GL_UNSIGNED_INT, 0);
-
-	glBindVertexArray(0);
-	glActiveTexture(GL_TEXTURE0);
+/// @brief issue the draw call of the Mesh, with its VAO bound and the uniforms set
+void Mesh::drawElements() {
+	glDrawElementsBaseVertex(GL_TRIANGLES, _indexCount, _indexType, (void*)_range.indexOffset, _range.baseVertex);
+	GLState::instance().countDraw(_indexCount / 3);
 }
 
 /// @brief setup the mesh and vertices linked to it (position, normal and texture vertices) and generates the normal and/or texture ones if not present
+/// @param arena GPU buffers of the Model
+/// @param min vec3 containing the minimum values of the model
+/// @param size Size of the model as a vec3
+void Mesh::setupMesh(const std::shared_ptr<MeshArena>& arena, vec3 min, vec3 size) {
+	prepare(min, size);
+	upload(arena, _vertices.data(), _vertices.size(), _indices.data(), _indices.size());
+}
+
+/// @brief CPU part of setupMesh: generates the normal and/or texture vertices if not present and reorders the triangles and vertices
+/// for the GPU (optimize). No GL call, can run on any thread
 /// @param min vec3 containing the minimum values of the model
 /// @param size Size of the model as a vec3
-void Mesh::setupMesh(vec3 min, vec3 size) {
+void Mesh::prepare(vec3 min, vec3 size) {
 	if (!_vnPresent){
 		generateDefaultVN(min, size);
 	}
 	if (!_vtPresent) {
 		generateDefaultVT(min, size + min);
 	}
-	for (size_t i = 0; i < _indices.size(); i += 3) {
-		int triID = i / 3;
-		_vertices[ _indices[i] ].triID = triID;
-		_vertices[ _indices[i+1] ].triID = triID;
-		_vertices[ _indices[i+2] ].triID = triID;
+	if (setup.optimizeMeshes)
+		optimize();
+}
+
+/// @brief send the vertices and indices of the mesh to the GPU, at the end of the buffers of its Model (MeshArena).
+///
+/// The arrays do not have to belong to the Mesh (e.g. mapped from the .scopbin cache), they are only read during the call.
+/// In a packed arena (--packed-vertices) the vertices are sent as PackedVertex (see packVertices). The indices are sent on
+/// 16 bits when the mesh has at most 65536 vertices, on 32 bits otherwise.
+/// @param arena GPU buffers of the Model
+/// @param vertices pointer to the final vertices
+/// @param vertexCount number of vertices
+/// @param indices pointer to the triangles indices
+/// @param indexCount number of indices
+void Mesh::upload(const std::shared_ptr<MeshArena>& arena, const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount) {
+	_arena = arena;
+	_indexCount = indexCount;
+
+	std::vector<uint16_t> narrow;
+	const void* indexData = indices;
+	_indexType = GL_UNSIGNED_INT;
+	if (vertexCount <= 65536) {
+		// every index fits in 16 bits: half the memory and index fetches
+		_indexType = GL_UNSIGNED_SHORT;
+		narrow.assign(indices, indices + indexCount);
+		indexData = narrow.data();
+	}
+	size_t indexSize = _indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+
+	if (arena->packed()) {
+		std::vector<PackedVertex> packed = packVertices(vertices, vertexCount);
+		_range = arena->append(packed.data(), vertexCount, indexData, indexCount, indexSize);
+		return;
+	}
+	_posMin = vec3(0.0f);
+	_posScale = vec3(1.0f);
+	_range = arena->append(vertices, vertexCount, indexData, indexCount, indexSize);
+}
+
+/// @brief Utilitary function converting a float to the nearest half float (IEEE 754 binary16, ties to even)
+static uint16_t floatToHalf(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = (bits >> 16) & 0x8000;
+	uint32_t mantissa = bits & 0x7fffff;
+	int exponent = static_cast<int>((bits >> 23) & 0xff);
+
+	if (exponent == 0xff)	// inf, nan
+		return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+	exponent += 15 - 127;
+	if (exponent >= 31)
+		return sign | 0x7c00;
+	int shift = 13;
+	uint32_t half;
+	if (exponent <= 0) {	// subnormal half
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x800000;
+		shift = 14 - exponent;
+		half = mantissa >> shift;
+	}
+	else
+		half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> shift);
+	uint32_t rest = mantissa & ((1u << shift) - 1);
+	uint32_t middle = 1u << (shift - 1);
+	if (rest > middle || (rest == middle && (half & 1)))
+		half++;	// may carry into the exponent, which is still the right rounding
+	return sign | static_cast<uint16_t>(half);
+}
+
+/// @brief Utilitary function mapping [0, 1] to an unsigned normalized 16 bits value
+static uint16_t toUnorm16(float value) {
+	return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+/**
+ * @brief Encode a unit normal on the octahedron folded on the z = 0 plane, both coordinates mapped to [0, 1]
+ * (decoded by octDecode in the vertex shader). A null normal gives (0, 0, 1).
+ */
+static void octEncode(const vec3& n, uint16_t out[2]) {
+	float l1 = fabs(n[0]) + fabs(n[1]) + fabs(n[2]);
+	float x = l1 > 0 ? n[0] / l1 : 0;
+	float y = l1 > 0 ? n[1] / l1 : 0;
+	if (n[2] < 0) {
+		float fx = (1.0f - fabs(y)) * (x >= 0 ? 1.0f : -1.0f);
+		float fy = (1.0f - fabs(x)) * (y >= 0 ? 1.0f : -1.0f);
+		x = fx;
+		y = fy;
 	}
-	glGenVertexArrays(1, &_VAO);
-	glGenBuffers(1, &_VBO);
-	glGenBuffers(1, &_EBO);
-
-	glBindVertexArray(_VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-	// changed &_vertices[0] to _vertices.data(), same for _indices, just in case. Might change it back
-	glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(Vertex), &_vertices[0], GL_STATIC_DRAW);  
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(unsigned int), 
-				&_indices[0], GL_STATIC_DRAW);
-
-	// vertex positions
-	glEnableVertexAttribArray(0);	
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-	// vertex normals
-	glEnableVertexAttribArray(1);	
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-	// vertex texture coords
-	glEnableVertexAttribArray(2);	
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-
-	glEnableVertexAttribArray(3);
-	glVertexAttribIPointer(3, 1, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, triID));
-	glBindVertexArray(0);
+	out[0] = toUnorm16(x * 0.5f + 0.5f);
+	out[1] = toUnorm16(y * 0.5f + 0.5f);
+}
+
+/// @brief --packed-vertices half of upload: pack the vertices (PackedVertex, 16 bytes instead of 32).
+/// Positions are stored relative to the AABB of the vertices, kept in _posMin / _posScale for the vertex shader.
+/// @param vertices pointer to the final vertices
+/// @param vertexCount number of vertices
+/// @return the packed vertices
+std::vector<PackedVertex> Mesh::packVertices(const Vertex* vertices, size_t vertexCount) {
+	vec3 min(0.0f), max(0.0f);
+	for (size_t i = 0; i < vertexCount; i++) {
+		for (int a = 0; a < 3; a++) {
+			min[a] = i ? std::min(min[a], vertices[i].Position[a]) : vertices[i].Position[a];
+			max[a] = i ? std::max(max[a], vertices[i].Position[a]) : vertices[i].Position[a];
+		}
+	}
+	_posMin = min;
+	_posScale = max - min;
+	vec3 inv;
+	for (int a = 0; a < 3; a++)
+		inv[a] = _posScale[a] > 0 ? 1.0f / _posScale[a] : 0.0f;
+
+	std::vector<PackedVertex> packed(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		const Vertex& v = vertices[i];
+		PackedVertex& p = packed[i];
+		for (int a = 0; a < 3; a++)
+			p.position[a] = toUnorm16((v.Position[a] - min[a]) * inv[a]);
+		p.pad = 0;
+		octEncode(v.Normal, p.normal);
+		p.texCoords[0] = floatToHalf(v.TexCoords[0]);
+		p.texCoords[1] = floatToHalf(v.TexCoords[1]);
+	}
+	return packed;
+}
+
+/// @brief reorder the triangles for the post-transform vertex cache, then their clusters against overdraw, then the vertices in their
+/// order of first use (see MeshOptimize.hpp), keeping the cache statistics of the index order before and after
+void Mesh::optimize() {
+	_cacheBefore = ::vertexCacheStats(_indices, _vertices.size());
+	std::vector<size_t> clusters;
+	optimizeVertexCache(_indices, _vertices.size(), &clusters);
+	optimizeOverdraw(_indices, _vertices, clusters);
+	optimizeVertexFetch(_vertices, _indices);
+	_cacheAfter = ::vertexCacheStats(_indices, _vertices.size());
 }
 
 //getters
@@ -149,11 +279,18 @@ std::vector<unsigned int>& Mesh::indices() {return _indices;}
 std::vector<unsigned int> Mesh::indices() const {return _indices;}
 std::string Mesh::materialName() const {return _materialName;}
 std::string Mesh::name() const {return _name;}
-GLuint& Mesh::VAO() {return _VAO;}
-GLuint& Mesh::VBO() {return _VAO;}
-GLuint& Mesh::EBO() {return _VAO;}
+GLuint Mesh::VAO() const {return _arena ? _arena->VAO() : 0;}
+GLuint Mesh::VBO() const {return _arena ? _arena->VBO() : 0;}
+GLuint Mesh::EBO() const {return _arena ? _arena->EBO() : 0;}
+const ArenaRange& Mesh::range() const {return _range;}
+size_t Mesh::indexCount() const {return _indexCount;}
+GLenum Mesh::indexType() const {return _indexType;}
+vec3 Mesh::posMin() const {return _posMin;}
+vec3 Mesh::posScale() const {return _posScale;}
+bool Mesh::packed() const {return _arena && _arena->packed();}
 bool Mesh::vnPresent() {return _vnPresent;};
 bool Mesh::vtPresent() {return _vtPresent;};
+VertexCacheStats Mesh::vertexCacheStats(bool optimized) const {return optimized ? _cacheAfter : _cacheBefore;}
 
 //setters
 void Mesh::vertices(std::vector<Vertex>& vertices) {_vertices = vertices;}
@@ -162,88 +299,3 @@ void Mesh::materialName(std::string matName) {_materialName = matName;}
 void Mesh::name(std::string name) {_name = name;}
 void Mesh::vnPresent(bool present) {_vnPresent = present;};
 void Mesh::vtPresent(bool present) {_vtPresent = present;};
-
-/**
- * @brief Generates UVs (Texture Coordonate) using cubic projection based on the dominant normal axis.
- * @param p The vertex position.
- * @param n The vertex normal used to choose the projection plane.
- * @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
- * @param size The size of the mesh's AABB.
- * @return The generated UV coordinates.
- */
-vec2 Mesh::generateCubicUV(const vec3& p, const vec3& n, 
-				const vec3& min, const vec3& size)
-{
-	vec2 uv;
-
-	// Find dominant axis of normal
-	float ax = fabs(n[0]);
-	float ay = fabs(n[1]);
-	float az = fabs(n[2]);
-
-	if (ax > ay && ax > az) {
-		// X-dominant → project onto YZ
-		uv[0] = (p[2] - min[2]) / size[2];
-		uv[1] = (p[1] - min[1]) / size[1];
-	}
-	else if (ay > ax && ay > az) {
-		// Y-dominant → project onto XZ
-		uv[0] = (p[0] - min[0]) / size[0];
-		uv[1] = (p[2] - min[2]) / size[2];
-	}
-	else {
-		// Z-dominant → project onto XY
-		uv[0] = (p[0] - min[0]) / size[0];
-		uv[1] = (p[1] - min[1]) / size[1];
-	}
-
-	return uv;
-}
-
-/// @brief Generate the Texture Coordonate (UV) for each Vertex
-/// @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
-/// @param max The maximum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
-void Mesh::generateDefaultVT(vec3 min, vec3 max)
-{
-	vec3 size = max - min;
-
-	// assign UVs based on X-Y projection
-	for (auto& v : _vertices) {
-		v.TexCoords = generateCubicUV(v.Position, v.Normal, min, size);
-	}
-}
-
-/// @brief Generate Default Normal vertices based on the normalized cross products, and texCords if also needed
-/// @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
-/// @param size The size of the mesh's AABB.
-void Mesh::generateDefaultVN(vec3 min, vec3 size) {
-
-	for (size_t i = 0; i < _indices.size(); i += 3) {
-
-		unsigned int i0 = _indices[i];
-		unsigned int i1 = _indices[i + 1];
-		unsigned int i2 = _indices[i + 2];
-
-		vec3 &p0 = _vertices[i0].Position;
-		vec3 &p1 = _vertices[i1].Position;
-		vec3 &p2 = _vertices[i2].Position;
-
-		vec3 faceNormal = normalize(cross(p1 - p0, p2 - p0));
-
-		_vertices[i0].Normal += faceNormal;
-		_vertices[i1].Normal += faceNormal;
-		_vertices[i2].Normal += faceNormal;
-
-
-		if (!_vtPresent){
-			_vertices[i0].TexCoords = generateCubicUV(p0, faceNormal, min, size);
-			_vertices[i1].TexCoords = generateCubicUV(p1, faceNormal, min, size);
-			_vertices[i2].TexCoords = generateCubicUV(p2, faceNormal, min, size);
-		}
-	}
-	_vtPresent = true;
-
-	// Normalize final normals
-	for (auto &v : _vertices)
-		v.Normal = normalize(v.Normal);
-}
@@ -6,6 +6,10 @@
 #include "Shader.hpp"
 #include "Includes/vml.hpp"
 #include "Includes/struct.hpp"
+#include "MeshOptimize.hpp"
+#include "MeshArena.hpp"
+#include "UniformBuffers.hpp"
+#include <memory>
 #include <header.h>
 
 class Mesh {
@@ -14,8 +18,14 @@ class Mesh {
 		Mesh(const Mesh& oth);
         Mesh& operator=(const Mesh& oth);
 
-		void Draw(Shader &shader, Material material);
-		void setupMesh(vec3 min, vec3 size);
+		void Draw(Shader &shader, Material material, const MaterialTable &table);
+		static void setDrawState(Shader &shader);
+		static void bindTextures(Material &material);
+		void setLayout(Shader &shader);
+		void drawElements();
+		void setupMesh(const std::shared_ptr<MeshArena>& arena, vec3 min, vec3 size);
+		void prepare(vec3 min, vec3 size);
+		void upload(const std::shared_ptr<MeshArena>& arena, const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount);
 
 		//getters
         std::vector<Vertex>& vertices();
@@ -24,11 +34,18 @@ class Mesh {
         std::vector<unsigned int> indices() const;
         std::string materialName() const;
         std::string name() const;
-		GLuint& VAO();
-		GLuint& VBO();
-		GLuint& EBO();
+		GLuint VAO() const;
+		GLuint VBO() const;
+		GLuint EBO() const;
+		const ArenaRange& range() const;
+		size_t indexCount() const;
+		GLenum indexType() const;
+		vec3 posMin() const;
+		vec3 posScale() const;
+		bool packed() const;
 		bool vnPresent();
 		bool vtPresent();
+		VertexCacheStats vertexCacheStats(bool optimized) const;
 
 		//setters
         void vertices(std::vector<Vertex>& vertices);
@@ -46,12 +63,17 @@ class Mesh {
         std::string                 _materialName;
 		bool						_vnPresent = false;
 		bool						_vtPresent = false;
-		GLuint 						_VAO;
-		GLuint 						_VBO;
-		GLuint 						_EBO;
+		std::shared_ptr<MeshArena>	_arena;				// buffers of the Model the Mesh was uploaded to
+		ArenaRange					_range;				// where in them
+		size_t						_indexCount = 0;
+		GLenum						_indexType = GL_UNSIGNED_INT;	// GL_UNSIGNED_SHORT for meshes of at most 65536 vertices
+		vec3						_posMin;			// position of the packed (0, 0, 0)
+		vec3						_posScale{1.0f};	// size of the packed AABB
+		VertexCacheStats			_cacheBefore;		// of the parsed index order
+		VertexCacheStats			_cacheAfter;		// once optimized (empty if not)
 
-		vec2 generateCubicUV(const vec3& p, const vec3& n, 
-                     const vec3& min, const vec3& size);
         void generateDefaultVT(vec3 min, vec3 max);
+		void optimize();
+		std::vector<PackedVertex> packVertices(const Vertex* vertices, size_t vertexCount);
 		void generateDefaultVN(vec3 min, vec3 size);
 };
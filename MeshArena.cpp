@@ -0,0 +1,116 @@
+#include "MeshArena.hpp"
+#include "Includes/struct.hpp"
+
+#include <algorithm>
+
+/// @brief create the VAO, the buffers are created by the first reserve or append
+/// @param packed the vertices are PackedVertex (--packed-vertices) instead of Vertex
+MeshArena::MeshArena(bool packed) : _packed(packed), _stride(packed ? sizeof(PackedVertex) : sizeof(Vertex)) {
+	glGenVertexArrays(1, &_VAO);
+}
+
+/// @brief delete the VAO and buffers, with the last Mesh or Model using them
+MeshArena::~MeshArena() {
+	if (_VAO)
+		glDeleteVertexArrays(1, &_VAO);
+	if (_VBO)
+		glDeleteBuffers(1, &_VBO);
+	if (_EBO)
+		glDeleteBuffers(1, &_EBO);
+}
+
+/// @brief make room for more vertices and indices at once, when their total is known (e.g. .scopbin cache)
+/// @param vertexCount number of vertices that will be appended
+/// @param indexBytes size of the indices that will be appended, alignment included
+void MeshArena::reserve(size_t vertexCount, size_t indexBytes) {
+	bool grown = grow(_VBO, _vertexCapacity, _vertexCount, vertexCount, _stride);
+	grown |= grow(_EBO, _indexCapacity, _indexBytes, indexBytes, 1);
+	if (grown)
+		bindBuffers();
+}
+
+/**
+ * @brief copy the vertices and indices of a Mesh at the end of the buffers
+ * @param vertices vertices in the layout of the arena (Vertex or PackedVertex)
+ * @param vertexCount number of vertices
+ * @param indices indices, relative to the first vertex of the Mesh
+ * @param indexCount number of indices
+ * @param indexSize 2 or 4 bytes
+ * @return where the Mesh is, to draw it
+ */
+ArenaRange MeshArena::append(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize) {
+	ArenaRange range;
+	size_t indexStart = (_indexBytes + 3) & ~static_cast<size_t>(3);	// 4 bytes aligned, whatever the previous index size
+	size_t indexEnd = indexStart + indexCount * indexSize;
+	bool grown = grow(_VBO, _vertexCapacity, _vertexCount, vertexCount, _stride);
+	grown |= grow(_EBO, _indexCapacity, _indexBytes, indexEnd - _indexBytes, 1);
+	if (grown)
+		bindBuffers();
+
+	glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, _vertexCount * _stride, vertexCount * _stride, vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// the EBO binding is VAO state: write it through the copy target to leave the bound VAO alone
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexStart, indexCount * indexSize, indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	range.baseVertex = static_cast<GLint>(_vertexCount);
+	range.indexOffset = indexStart;
+	_vertexCount += vertexCount;
+	_indexBytes = indexEnd;
+	return range;
+}
+
+/// @brief Utilitary function making a buffer big enough for needed more units after the used ones: a bigger buffer (at least twice)
+/// is created and the used part copied to it on the GPU
+/// @return true if the buffer was replaced, the VAO then has to be updated (bindBuffers)
+bool MeshArena::grow(GLuint& buffer, size_t& capacity, size_t used, size_t needed, size_t unit) {
+	if (used + needed <= capacity && buffer)
+		return false;
+	size_t newCapacity = std::max(used + needed, capacity * 2);
+	GLuint newBuffer;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * unit, nullptr, GL_STATIC_DRAW);
+	if (buffer && used) {
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used * unit);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	if (buffer)
+		glDeleteBuffers(1, &buffer);
+	buffer = newBuffer;
+	capacity = newCapacity;
+	return true;
+}
+
+/// @brief Utilitary function (re)attaching the current buffers to the VAO and describing the vertex layout, after they were created or grown
+void MeshArena::bindBuffers() {
+	glBindVertexArray(_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	if (_packed) {
+		// unorm16 position in the Mesh AABB, unorm16 octahedral normal, half float UVs (decoded by the vertex shader)
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, _stride, (void*)offsetof(PackedVertex, position));
+		glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, _stride, (void*)offsetof(PackedVertex, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, _stride, (void*)offsetof(PackedVertex, texCoords));
+	}
+	else {
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, _stride, (void*)offsetof(Vertex, Position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, _stride, (void*)offsetof(Vertex, Normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, _stride, (void*)offsetof(Vertex, TexCoords));
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//getters
+bool MeshArena::packed() const {return _packed;}
+GLuint MeshArena::VAO() const {return _VAO;}
+GLuint MeshArena::VBO() const {return _VBO;}
+GLuint MeshArena::EBO() const {return _EBO;}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// where the data of a Mesh is in its MeshArena
+struct ArenaRange {
+	GLint	baseVertex = 0;		// first vertex, added to each index by glDrawElementsBaseVertex
+	size_t	indexOffset = 0;	// offset in bytes of the first index in the EBO
+};
+
+/**
+ * @brief GPU geometry of a whole Model: one VBO holding the vertices of every Mesh one after the other, one EBO holding their
+ * indices and one VAO describing them, so the Meshes are drawn one after the other without switching VAO.
+ *
+ * Each Mesh keeps its ArenaRange and draws with glDrawElementsBaseVertex: its indices stay relative to its own first vertex,
+ * so a small Mesh keeps 16 bits indices even far in the VBO. The buffers grow on the GPU (glCopyBufferSubData) when a
+ * progressive load appends Meshes. Owned through std::shared_ptr by the Model and its Meshes. GL thread only.
+ */
+class MeshArena {
+	public:
+		MeshArena(bool packed);
+		MeshArena(const MeshArena& oth) = delete;
+		MeshArena& operator=(const MeshArena& oth) = delete;
+		~MeshArena();
+
+		void		reserve(size_t vertexCount, size_t indexBytes);
+		ArenaRange	append(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, size_t indexSize);
+
+		//getters
+		bool	packed() const;
+		GLuint	VAO() const;
+		GLuint	VBO() const;
+		GLuint	EBO() const;
+
+	private:
+		bool	_packed;		// vertices are PackedVertex instead of Vertex
+		size_t	_stride;
+		GLuint	_VAO = 0;
+		GLuint	_VBO = 0;
+		GLuint	_EBO = 0;
+		size_t	_vertexCount = 0;
+		size_t	_vertexCapacity = 0;	// in vertices
+		size_t	_indexBytes = 0;
+		size_t	_indexCapacity = 0;		// in bytes
+
+		bool	grow(GLuint& buffer, size_t& capacity, size_t used, size_t needed, size_t unit);
+		void	bindBuffers();
+};
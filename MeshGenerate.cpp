@@ -0,0 +1,280 @@
+#include "Mesh.hpp"
+#include "ThreadPool.hpp"
+#include "Includes/header.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <vector>
+
+// triangles or vertices per task of the generation kernels, a Mesh smaller than two of them is done on the calling thread
+static const size_t	GENERATE_GRAIN = 1 << 15;
+// generateDefaultVN split in fewer tasks is done on the calling thread: its passes do about twice the work of the serial loop
+static const size_t	GENERATE_VN_MIN_TASKS = 4;
+// vertex blocks per task of the split generateDefaultVN, so that the power of two blocks share the vertices evenly
+static const size_t	GENERATE_BLOCKS_PER_TASK = 8;
+// normals per batch of vml::normalize (contiguous vec3, on the stack)
+static const size_t	NORMALIZE_BATCH = 256;
+
+/// @brief workers of the generation kernels, started the first time a Mesh is large enough to split
+static ThreadPool& generatePool() {
+	static ThreadPool pool(setup.loaderThreads);
+	return pool;
+}
+
+/// @brief Utilitary function: number of tasks parallelFor splits count elements into, 1 for the calling thread alone
+static size_t parallelTasks(size_t count) {
+	size_t threads = setup.loaderThreads ? setup.loaderThreads : ThreadPool::hardwareThreads();
+	return std::max<size_t>(1, std::min(threads, count / GENERATE_GRAIN));
+}
+
+/**
+ * @brief Utilitary function running work(i) for i in [0, tasks), on generatePool unless there is only one
+ * @param tasks number of tasks, see parallelTasks
+ * @param work callable(size_t task)
+ * @throw the first exception thrown by work
+ */
+template<typename F>
+static void runTasks(size_t tasks, F work) {
+	if (tasks < 2) {
+		work(0);
+		return;
+	}
+	std::vector<std::future<void>> done;
+	for (size_t i = 0; i < tasks; i++)
+		done.push_back(generatePool().submit([&work, i]() { work(i); }));
+	for (auto& f : done)
+		f.get();
+}
+
+/**
+ * @brief Utilitary function running work(begin, end) over [0, count) in ranges of at least GENERATE_GRAIN, on generatePool
+ * unless setup.loaderThreads is 1 or there is not enough work. The ranges are disjoint: each task writes its own elements.
+ * @param count number of elements
+ * @param work callable(size_t begin, size_t end)
+ * @throw the first exception thrown by work
+ */
+template<typename F>
+static void parallelFor(size_t count, F work) {
+	size_t tasks = parallelTasks(count);
+	runTasks(tasks, [&work, count, tasks](size_t i) { work(count * i / tasks, count * (i + 1) / tasks); });
+}
+
+/**
+ * @brief Generates UVs (Texture Coordonate) using cubic projection based on the dominant normal axis.
+ * @param p The vertex position.
+ * @param n The vertex normal used to choose the projection plane.
+ * @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
+ * @param size The size of the mesh's AABB.
+ * @return The generated UV coordinates.
+ */
+static vec2 generateCubicUV(const vec3& p, const vec3& n, const vec3& min, const vec3& size) {
+	vec2 uv;
+
+	// Find dominant axis of normal
+	float ax = std::fabs(n[0]);
+	float ay = std::fabs(n[1]);
+	float az = std::fabs(n[2]);
+
+	if (ax > ay && ax > az) {
+		// X-dominant → project onto YZ
+		uv[0] = (p[2] - min[2]) / size[2];
+		uv[1] = (p[1] - min[1]) / size[1];
+	}
+	else if (ay > ax && ay > az) {
+		// Y-dominant → project onto XZ
+		uv[0] = (p[0] - min[0]) / size[0];
+		uv[1] = (p[2] - min[2]) / size[2];
+	}
+	else {
+		// Z-dominant → project onto XY
+		uv[0] = (p[0] - min[0]) / size[0];
+		uv[1] = (p[1] - min[1]) / size[1];
+	}
+
+	return uv;
+}
+
+/**
+ * @brief generateCubicUV of 4 vertices at once, without branch: every projection is computed then the dominant axis of
+ * each normal picks its lanes. Same operations as generateCubicUV, so the same UVs bit for bit
+ * @param position callable(size_t i) returning the position of vertex i
+ * @param normal callable(size_t i) returning the normal choosing the projection of vertex i
+ * @param store callable(size_t i, vec2 uv)
+ */
+template<typename P, typename N, typename S>
+static void cubicUVKernel(size_t begin, size_t end, const vec3& min, const vec3& size, P position, N normal, S store) {
+	size_t i = begin;
+#if defined(__SSE__) || defined(_M_X64)
+	const __m128 signMask = _mm_set1_ps(-0.f);
+	for (; i + 4 <= end; i += 4) {
+		__m128 p[3], n[3], uvw[3];
+		for (int c = 0; c < 3; c++) {
+			p[c] = _mm_setr_ps(position(i)[c], position(i + 1)[c], position(i + 2)[c], position(i + 3)[c]);
+			n[c] = _mm_andnot_ps(signMask, _mm_setr_ps(normal(i)[c], normal(i + 1)[c], normal(i + 2)[c], normal(i + 3)[c]));
+			uvw[c] = _mm_div_ps(_mm_sub_ps(p[c], _mm_set1_ps(min[c])), _mm_set1_ps(size[c]));
+		}
+		// X-dominant → YZ, Y-dominant → XZ, else XY (NaN normals included, as the comparisons are then false)
+		__m128 xDom = _mm_and_ps(_mm_cmpgt_ps(n[0], n[1]), _mm_cmpgt_ps(n[0], n[2]));
+		__m128 yDom = _mm_and_ps(_mm_cmpgt_ps(n[1], n[0]), _mm_cmpgt_ps(n[1], n[2]));
+		__m128 u = _mm_or_ps(_mm_and_ps(xDom, uvw[2]), _mm_andnot_ps(xDom, uvw[0]));
+		__m128 v = _mm_or_ps(_mm_and_ps(yDom, uvw[2]), _mm_andnot_ps(yDom, uvw[1]));
+		alignas(16) float us[4], vs[4];
+		_mm_store_ps(us, u);
+		_mm_store_ps(vs, v);
+		for (int k = 0; k < 4; k++)
+			store(i + k, vec2{us[k], vs[k]});
+	}
+#endif
+	for (; i < end; i++)
+		store(i, generateCubicUV(position(i), normal(i), min, size));
+}
+
+/// @brief Generate the Texture Coordonate (UV) for each Vertex, see generateCubicUV (vectorized and split on generatePool)
+/// @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
+/// @param max The maximum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
+void Mesh::generateDefaultVT(vec3 min, vec3 max)
+{
+	vec3 size = max - min;
+	Vertex* vertices = _vertices.data();
+
+	parallelFor(_vertices.size(), [=](size_t begin, size_t end) {
+		cubicUVKernel(begin, end, min, size,
+			[vertices](size_t i) -> const vec3& { return vertices[i].Position; },
+			[vertices](size_t i) -> const vec3& { return vertices[i].Normal; },
+			[vertices](size_t i, vec2 uv) { vertices[i].TexCoords = uv; });
+	});
+}
+
+/// @brief Utilitary function: normal of a triangle, from its first corner
+static vec3 faceNormal(Vertex* vertices, const unsigned int* tri) {
+	const vec3& p0 = vertices[tri[0]].Position;
+	return normalize(cross(vertices[tri[1]].Position - p0, vertices[tri[2]].Position - p0));
+}
+
+/**
+ * @brief Generate Default Normal vertices based on the normalized cross products, and texCords if also needed
+ *
+ * Serial unless it splits in GENERATE_VN_MIN_TASKS tasks: each triangle adds its normal to its 3 vertices. Split on
+ * generatePool otherwise, in O(vertices + triangles) like the serial loop: the vertices are cut in blocks, and a table from
+ * each block to the triangle corners using its vertices (a CSR with a row per block, in triangle order) is built once by a
+ * two pass counting sort over chunks of triangles, the first pass also computing the face normals. Each task then adds the
+ * normals of the corners of its blocks to their vertices: no two tasks write the same vertex and each vertex gets its sum
+ * in the serial order, the same normals bit for bit. The normalization (vml::normalize by batches) and the UVs
+ * (cubicUVKernel, from the normal of the last triangle using each vertex like the serial loop) then run on the same blocks.
+ * @param min The minimum bounds of the mesh's Axis-Aligned Bounding Box (AABB).
+ * @param size The size of the mesh's AABB.
+ */
+void Mesh::generateDefaultVN(vec3 min, vec3 size) {
+	size_t vertexCount = _vertices.size();
+	size_t triangleCount = _indices.size() / 3;
+	const unsigned int* indices = _indices.data();
+	Vertex* vertices = _vertices.data();
+	bool generateVT = !_vtPresent;
+	std::vector<vec3> lastNormals(generateVT ? vertexCount : 0);
+	std::vector<char> usedFlags(generateVT ? vertexCount : 0, 0);
+	vec3* lastNormal = generateVT ? lastNormals.data() : nullptr;
+	char* used = usedFlags.data();
+
+	// everything captured by value: through references the compiler reloads the pointers after each float store
+	auto finish = [=](size_t begin, size_t end) {
+		// Normalize final normals
+		vec3 normals[NORMALIZE_BATCH];
+		for (size_t v = begin; v < end; v += NORMALIZE_BATCH) {
+			size_t n = std::min(NORMALIZE_BATCH, end - v);
+			for (size_t k = 0; k < n; k++)
+				normals[k] = vertices[v + k].Normal;
+			normalize(normals, normals, n);
+			for (size_t k = 0; k < n; k++)
+				vertices[v + k].Normal = normals[k];
+		}
+
+		if (generateVT) {
+			// an unused vertex keeps its UV
+			cubicUVKernel(begin, end, min, size,
+				[vertices](size_t i) -> const vec3& { return vertices[i].Position; },
+				[lastNormal](size_t i) -> const vec3& { return lastNormal[i]; },
+				[vertices, used](size_t i, vec2 uv) { if (used[i]) vertices[i].TexCoords = uv; });
+		}
+	};
+
+	if (parallelTasks(vertexCount) < GENERATE_VN_MIN_TASKS) {
+		for (size_t t = 0; t < triangleCount; t++) {
+			const unsigned int* tri = indices + t * 3;
+			vec3 normal = faceNormal(vertices, tri);
+			for (int c = 0; c < 3; c++) {
+				vertices[tri[c]].Normal += normal;
+				if (lastNormal) {
+					lastNormal[tri[c]] = normal;
+					used[tri[c]] = 1;
+				}
+			}
+		}
+		finish(0, vertexCount);
+		_vtPresent = true;
+		return;
+	}
+
+	// vertices in blocks of 1 << shift (a shift, not a division per corner), several per task for balance: task r does the
+	// blocks [blockCount * r / tasks, blockCount * (r + 1) / tasks), and chunk c of the triangles is cut the same way
+	size_t tasks = parallelTasks(vertexCount);
+	unsigned int shift = 0;
+	while ((vertexCount >> (shift + 1)) >= tasks * GENERATE_BLOCKS_PER_TASK)
+		shift++;
+	size_t blockCount = ((vertexCount - 1) >> shift) + 1;
+	// scratch written before being read, left uninitialized: the face normals (3 floats each) and the corners of the blocks,
+	// as indices in _indices (triangle = corner / 3)
+	std::unique_ptr<float[]> faceNormals = std::make_unique_for_overwrite<float[]>(triangleCount * 3);
+	std::unique_ptr<unsigned int[]> blockCorners = std::make_unique_for_overwrite<unsigned int[]>(triangleCount * 3);
+	std::vector<size_t> cornerCounts(tasks * blockCount, 0);	// then the start of the corners of chunk c in block b, [c * blockCount + b]
+	std::vector<size_t> blockStarts(blockCount + 1);
+	float* normals = faceNormals.get();
+	unsigned int* corners = blockCorners.get();
+	size_t* counts = cornerCounts.data();
+
+	runTasks(tasks, [=](size_t c) {
+		size_t* chunkCounts = counts + c * blockCount;
+		for (size_t t = triangleCount * c / tasks; t < triangleCount * (c + 1) / tasks; t++) {
+			vec3 normal = faceNormal(vertices, indices + t * 3);
+			for (int k = 0; k < 3; k++) {
+				normals[t * 3 + k] = normal[k];
+				chunkCounts[indices[t * 3 + k] >> shift]++;
+			}
+		}
+	});
+	// blocks one after the other, in a block the corners of chunk 0 then chunk 1...: triangle order
+	size_t offset = 0;
+	for (size_t b = 0; b < blockCount; b++) {
+		blockStarts[b] = offset;
+		for (size_t c = 0; c < tasks; c++) {
+			size_t count = counts[c * blockCount + b];
+			counts[c * blockCount + b] = offset;
+			offset += count;
+		}
+	}
+	blockStarts[blockCount] = offset;
+	runTasks(tasks, [=](size_t c) {
+		size_t* next = counts + c * blockCount;
+		for (size_t i = triangleCount * c / tasks * 3; i < triangleCount * (c + 1) / tasks * 3; i++)
+			corners[next[indices[i] >> shift]++] = static_cast<unsigned int>(i);
+	});
+
+	// same float additions as vec3::operator+=, component by component
+	const size_t* starts = blockStarts.data();
+	runTasks(tasks, [=](size_t r) {
+		size_t firstBlock = blockCount * r / tasks, endBlock = blockCount * (r + 1) / tasks;
+		for (size_t k = starts[firstBlock]; k < starts[endBlock]; k++) {
+			unsigned int v = indices[corners[k]];
+			const float* normal = normals + corners[k] / 3 * 3;
+			for (int c = 0; c < 3; c++)
+				vertices[v].Normal[c] += normal[c];
+			if (lastNormal) {
+				lastNormal[v] = vec3{normal[0], normal[1], normal[2]};
+				used[v] = 1;
+			}
+		}
+		finish(firstBlock << shift, std::min(endBlock << shift, vertexCount));
+	});
+	_vtPresent = true;
+}
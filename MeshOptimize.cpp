@@ -0,0 +1,253 @@
+#include "MeshOptimize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// a cluster of the Tipsify order is split when its ACMR up to a triangle is below this factor of its whole ACMR (see optimizeOverdraw)
+static const double	OVERDRAW_THRESHOLD = 1.05;
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& oth) {
+	triangles += oth.triangles;
+	vertices += oth.vertices;
+	transformed += oth.transformed;
+	return *this;
+}
+
+/**
+ * @brief Utilitary class simulating the post-transform FIFO cache: a vertex is transformed if it is not one of the last
+ * VERTEX_CACHE_SIZE vertices transformed. Stamps instead of a queue, so a lookup is O(1)
+ */
+class FifoCache {
+	public:
+		FifoCache(size_t vertexCount) : _stamps(vertexCount, 0) {}
+
+		/// @return true if the vertex had to be transformed
+		bool	access(unsigned int v) {
+			if (_stamps[v] && _time - _stamps[v] < VERTEX_CACHE_SIZE)
+				return false;
+			_stamps[v] = ++_time;
+			return true;
+		}
+		/// @brief empty the cache, in O(1)
+		void	flush() {
+			_time += VERTEX_CACHE_SIZE;
+		}
+
+	private:
+		std::vector<size_t>	_stamps;	// time of the last transform of each vertex, 0 if never
+		size_t				_time = 0;
+};
+
+/// @brief cache statistics of an index buffer (see VertexCacheStats)
+/// @param indices triangle list
+/// @param vertexCount number of vertices the indices point to
+VertexCacheStats vertexCacheStats(const std::vector<unsigned int>& indices, size_t vertexCount) {
+	VertexCacheStats stats;
+	stats.triangles = indices.size() / 3;
+	stats.vertices = vertexCount;
+	FifoCache cache(vertexCount);
+	for (unsigned int idx : indices)
+		stats.transformed += cache.access(idx);
+	return stats;
+}
+
+/**
+ * @brief Utilitary function of optimizeVertexCache: next fanning vertex once the previous one has no triangle left.
+ * Last vertices emitted first (most likely still in the cache), then the first vertex in input order with triangles left
+ * @return the vertex, or -1 when every triangle was emitted
+ */
+static long skipDeadEnd(std::vector<unsigned int>& deadEnd, const std::vector<unsigned int>& live, size_t& cursor) {
+	while (!deadEnd.empty()) {
+		unsigned int v = deadEnd.back();
+		deadEnd.pop_back();
+		if (live[v] > 0)
+			return v;
+	}
+	for (; cursor < live.size(); cursor++)
+		if (live[cursor] > 0)
+			return cursor;
+	return -1;
+}
+
+/**
+ * @brief reorder the triangles for the post-transform cache with Tipsify (Sander, Nehab and Barczak 2007): emit every triangle
+ * around a fanning vertex, then fan around the vertex of the last triangles that will still be in the cache after its own
+ * remaining triangles, linear in the number of triangles.
+ * @param indices triangle list, reordered in place (the triangles keep their winding)
+ * @param vertexCount number of vertices the indices point to
+ * @param clusters if not null, receives the first index of each run of triangles started on a cold cache, for optimizeOverdraw
+ */
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* clusters) {
+	size_t triangleCount = indices.size() / 3;
+	if (clusters)
+		clusters->clear();
+	if (triangleCount == 0)
+		return;
+
+	// triangles of each vertex (compressed adjacency)
+	std::vector<unsigned int> live(vertexCount, 0);
+	for (unsigned int idx : indices)
+		live[idx]++;
+	std::vector<size_t> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + live[v];
+	std::vector<unsigned int> adjacency(indices.size());
+	{
+		std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			adjacency[fill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	std::vector<size_t> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	size_t time = VERTEX_CACHE_SIZE + 1;
+	size_t cursor = 0;
+	long fanning = indices[0];
+	bool cold = true;
+
+	while (fanning >= 0) {
+		if (cold && clusters)
+			clusters->push_back(result.size());
+		candidates.clear();
+		for (size_t a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+			unsigned int t = adjacency[a];
+			if (emitted[t])
+				continue;
+			emitted[t] = true;
+			for (int c = 0; c < 3; c++) {
+				unsigned int v = indices[t * 3 + c];
+				result.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cacheTime[v] > VERTEX_CACHE_SIZE)
+					cacheTime[v] = time++;
+			}
+		}
+
+		// best candidate: still has triangles and will still be cached once they are emitted, the oldest in the cache first
+		long best = -1;
+		long bestPriority = -1;
+		for (unsigned int v : candidates) {
+			if (live[v] == 0)
+				continue;
+			long priority = 0;
+			if (time - cacheTime[v] + 2 * live[v] <= VERTEX_CACHE_SIZE)
+				priority = time - cacheTime[v];
+			if (priority > bestPriority) {
+				best = v;
+				bestPriority = priority;
+			}
+		}
+		cold = best < 0;
+		fanning = best >= 0 ? best : skipDeadEnd(deadEnd, live, cursor);
+	}
+	indices.swap(result);
+}
+
+/**
+ * @brief reorder the clusters of an optimizeVertexCache order so the ones facing outward are drawn first and hide the ones
+ * behind them (early depth test), without undoing the cache order inside the clusters.
+ *
+ * The clusters are first split where the ACMR of their start is low enough (OVERDRAW_THRESHOLD), then sorted by how much their
+ * area weighted normal points away from the mesh centroid.
+ * @param indices triangle list, in the optimizeVertexCache order
+ * @param vertices vertices the indices point to
+ * @param clusters first index of each cluster, from optimizeVertexCache
+ */
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<size_t> clusters) {
+	if (clusters.empty() || indices.empty())
+		return;
+	clusters.push_back(indices.size());
+
+	// soft boundaries
+	std::vector<size_t> split;
+	FifoCache cache(vertices.size());
+	for (size_t c = 0; c + 1 < clusters.size(); c++) {
+		size_t begin = clusters[c], end = clusters[c + 1];
+		size_t clusterTransformed = 0;
+		cache.flush();
+		for (size_t i = begin; i < end; i++)
+			clusterTransformed += cache.access(indices[i]);
+		double clusterAcmr = static_cast<double>(clusterTransformed) / ((end - begin) / 3);
+
+		split.push_back(begin);
+		cache.flush();
+		size_t transformed = 0, start = begin;
+		for (size_t i = begin; i < end; i += 3) {
+			for (int k = 0; k < 3; k++)
+				transformed += cache.access(indices[i + k]);
+			size_t triangles = (i + 3 - start) / 3;
+			if (i + 3 < end && triangles >= VERTEX_CACHE_SIZE && static_cast<double>(transformed) / triangles <= clusterAcmr * OVERDRAW_THRESHOLD) {
+				split.push_back(i + 3);
+				start = i + 3;
+				transformed = 0;
+				cache.flush();
+			}
+		}
+	}
+	split.push_back(indices.size());
+
+	// mesh centroid, then cluster sort keys
+	vec3 meshCentroid(0.0f);
+	double meshArea = 0;
+	std::vector<vec3> centroids(split.size() - 1, vec3(0.0f));
+	std::vector<vec3> normals(split.size() - 1, vec3(0.0f));
+	std::vector<double> areas(split.size() - 1, 0);
+	for (size_t c = 0; c + 1 < split.size(); c++) {
+		for (size_t i = split[c]; i < split[c + 1]; i += 3) {
+			vec3 p0 = vertices[indices[i]].Position;
+			vec3 p1 = vertices[indices[i + 1]].Position;
+			vec3 p2 = vertices[indices[i + 2]].Position;
+			vec3 n = cross(p1 - p0, p2 - p0);
+			float area = std::sqrt(dot(n, n));
+			centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			normals[c] += n;
+			areas[c] += area;
+		}
+		meshCentroid += centroids[c];
+		meshArea += areas[c];
+		if (areas[c] > 0)
+			centroids[c] = centroids[c] * static_cast<float>(1.0 / areas[c]);
+	}
+	if (meshArea > 0)
+		meshCentroid = meshCentroid * static_cast<float>(1.0 / meshArea);
+
+	std::vector<float> keys(split.size() - 1);
+	for (size_t c = 0; c < keys.size(); c++) {
+		float length = std::sqrt(dot(normals[c], normals[c]));
+		keys[c] = length > 0 ? dot(centroids[c] - meshCentroid, normals[c]) / length : 0;
+	}
+	std::vector<size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (size_t c : order)
+		result.insert(result.end(), indices.begin() + split[c], indices.begin() + split[c + 1]);
+	indices.swap(result);
+}
+
+/// @brief reorder the vertices in the order the indices first use them, so the vertex fetches walk the buffer forward. Unused vertices are dropped
+/// @param vertices vertices, reordered in place
+/// @param indices triangle list, remapped to the new vertex order
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+	const unsigned int unused = ~0u;
+	std::vector<unsigned int> remap(vertices.size(), unused);
+	std::vector<Vertex> result;
+	result.reserve(vertices.size());
+	for (unsigned int& idx : indices) {
+		if (remap[idx] == unused) {
+			remap[idx] = result.size();
+			result.push_back(vertices[idx]);
+		}
+		idx = remap[idx];
+	}
+	vertices.swap(result);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Includes/struct.hpp"
+#include <cstddef>
+#include <vector>
+
+// post-transform vertex cache simulated by the statistics and optimized for (FIFO, like most GPUs)
+static const unsigned int	VERTEX_CACHE_SIZE = 16;
+
+/**
+ * @brief vertex shader work of an index buffer, measured with a FIFO cache of VERTEX_CACHE_SIZE entries.
+ *
+ * ACMR (average cache miss ratio) = transformed vertices / triangles, 0.5 at best on a regular grid and 3 at worst.
+ * ATVR (average transform to vertex ratio) = transformed vertices / vertices, 1 at best.
+ */
+struct VertexCacheStats {
+	size_t	triangles = 0;
+	size_t	vertices = 0;
+	size_t	transformed = 0;
+
+	double	acmr() const { return triangles ? static_cast<double>(transformed) / triangles : 0; }
+	double	atvr() const { return vertices ? static_cast<double>(transformed) / vertices : 0; }
+	VertexCacheStats& operator+=(const VertexCacheStats& oth);
+};
+
+VertexCacheStats	vertexCacheStats(const std::vector<unsigned int>& indices, size_t vertexCount);
+void				optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* clusters = nullptr);
+void				optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<size_t> clusters);
+void				optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
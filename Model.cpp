@@ -6,11 +6,12 @@ Model::Model() {}
 
 /// @brief custom cronstructor that load an object into the Model and devide them in meshes and materials
 /// @param path argument given to the program as the path the .obj
+/// @param progressive parse the .obj on a worker thread, the Meshes are then added by pollLoad as they are ready
 /// @throw any exception caught by the loadModel function
-Model::Model(char *path)
+Model::Model(char *path, bool progressive)
 {
 	try {
-		loadModel(path);
+		loadModel(path, progressive);
 	}
 	catch(std::exception &e) {
 		throw;
@@ -23,43 +24,83 @@ Model::Model(char *path)
 Model& Model::operator=(const Model& oth) {
 	if (this != &oth) {
 		meshes = oth.meshes;
+		_arena = oth._arena;
 		materials = oth.materials;
 		directory = oth.directory;
 		_name = oth._name;
+		_sources = oth._sources;
+		_fromCache = oth._fromCache;
 		_min = oth._min;
 		_max = oth._max;
+		_drawsChanged = true;
+		_materialTable.invalidate();
 	}
 	return *this;
 }
 
-/// @brief Model destructor: destroy and clean all thing related to the Model (Textures, Mehes's VAO, VBO, EBO)
+/// @brief Model destructor: stop a progressive load still running, destroy and clean all thing related to the Model.
+/// The VAO, VBO and EBO are released with the MeshArena and the Material textures with the materials (see TextureCache)
 Model::~Model() {
-	for (auto& it: materials){
-		auto& mat = it.second;
-		if (mat.diffuseTex.id() != 0)
-			mat.diffuseTex.deleteTex();
-		if (mat.specularTex.id() != 0)
-			mat.specularTex.deleteTex();
-		if (mat.normalTex.id() != 0)
-			mat.normalTex.deleteTex();
+	if (_stream) {
+		_stream->cancel = true;
+		if (_stream->worker.joinable())
+			_stream->worker.join();
 	}
-	for (auto& mesh: meshes) {
-		if (mesh.VAO())
-			glDeleteVertexArrays(1, &(mesh.VAO()));
-		if (mesh.VBO())
-			glDeleteBuffers(1, &(mesh.VBO()));
-		if (mesh.EBO())
-			glDeleteBuffers(1, &(mesh.EBO()));
+}
+
+/// @brief Model Draw function that queues each Mesh with its Material and draws them sorted by Material (see RenderQueue),
+/// or submit them all at once with setup.indirectDraw (see drawIndirect)
+/// @param shaders variants of the model shader, one per Material textures and view mode
+void Model::Draw(ShaderVariants &shaders) {
+	if (!_arena)
+		return;
+	// texture uploads and MeshArena growth since the last frame did not go through GLState
+	GLState::instance().invalidate();
+	if (setup.indirectDraw && drawIndirect(shaders))
+		return;
+	for (Mesh& x : meshes) {
+		Material& material = materials[x.materialName()];
+		_queue.push(shaders.get(material), _materialTable, material, x);
 	}
-	if (setup.custom.id())
-		setup.custom.deleteTex();
+	updateMaterialTable();
+	_queue.flush();
 }
 
-/// @brief Model Draw function that call each Mesh Draw function with the shader program needed for it
-/// @param shader shader program class
-void Model::Draw(Shader &shader) {
-	for (Mesh& x : meshes)
-		x.Draw(shader, materials[x.materialName()]);
+/// @brief (re)build the MaterialTable if a Material was added since the last build, Materials being neither removed nor changed.
+/// The Meshes whose Material the .mtl lacks must have been given their default one (materials[name]) before
+void Model::updateMaterialTable() {
+	if (_materialTable.size() != materials.size())
+		_materialTable.build(materials);
+}
+
+/// @brief draw every Mesh with the IndirectDraws of the Model, (re)built when a Mesh or a texture was added since the last frame
+/// @param shaders variants of the model shader, one per Material textures and view mode
+/// @return false if the draws could not be built, the Meshes are then to be drawn one by one
+bool Model::drawIndirect(ShaderVariants &shaders) {
+	if (_drawsChanged) {
+		_drawsChanged = false;
+		for (Mesh& x : meshes)
+			materials[x.materialName()];
+		updateMaterialTable();
+		if (!_indirect)
+			_indirect = std::make_unique<IndirectDraws>();
+		if (!_indirect->build(meshes, materials, *_arena))
+			_indirect.reset();
+		GLState::instance().invalidate();
+	}
+	if (!_indirect)
+		return false;
+	GLState::instance().bindVertexArray(_arena->VAO());
+	_indirect->draw(shaders, _materialTable);
+	GLState::instance().bindVertexArray(0);
+	return true;
+}
+
+/// @brief GPU buffers of the Meshes, created on first use with the vertex layout of setup.packedVertices. GL thread only
+const std::shared_ptr<MeshArena>& Model::arena() {
+	if (!_arena)
+		_arena = std::make_shared<MeshArena>(setup.packedVertices);
+	return _arena;
 }
 
 //getters
@@ -75,6 +116,16 @@ size_t Model::ms() {return meshes.size();}
 std::vector<Mesh> Model::getMeshes() {return meshes;}
 vec3 Model::min() {return _min;}
 vec3 Model::max() {return _max;}
+bool Model::fromCache() {return _fromCache;}
+const std::vector<TextureTiming>& Model::textureTimings() {return _textureTimings;}
+
+/// @brief vertex cache statistics of every Mesh together, of the parsed index order or of the optimized one (empty when loaded from the cache)
+VertexCacheStats Model::vertexCacheStats(bool optimized) {
+	VertexCacheStats stats;
+	for (auto& mesh : meshes)
+		stats += mesh.vertexCacheStats(optimized);
+	return stats;
+}
 
 
 /// @brief check new values and (re)define min and max value if needed 
@@ -98,8 +149,10 @@ void Model::loadMtl(std::string path) {
 	std::ifstream file(directory + path);
 	if (!file.is_open())
 		throw std::runtime_error("Error: Material File could not be opened or does not exist.");
+	_sources.push_back(directory + path);
 	std::string line;
 	Material currentMaterial;
+	std::vector<std::string> names;
 	float x,y,z;
 
 	while (getline(file, line)) {
@@ -112,6 +165,7 @@ void Model::loadMtl(std::string path) {
 				materials[currentMaterial.name] = currentMaterial; // store previous
 			currentMaterial = Material(); // reset
 			ss >> currentMaterial.name;
+			names.push_back(currentMaterial.name);
 		}
 		else if (type == "Ka"){
 			ss >> x >> y >> z;
@@ -140,17 +194,74 @@ void Model::loadMtl(std::string path) {
 		materials[currentMaterial.name] = currentMaterial;
 
 	file.close();
+	// no GL context on the worker of a progressive load, the GL thread loads the textures
+	if (_sink)
+		publishMaterials(names);
+	else
+		loadMaterialTextures();
+}
+
+/// @brief start loading the textures (map_Kd, map_Ks, map_Bump) of every Material, relatively to the .obj directory (see queueTexture)
+void Model::loadMaterialTextures() {
+	for (auto& it : materials)
+		loadMaterialTextures(it.second);
+}
+
+/// @brief start loading the textures (map_Kd, map_Ks, map_Bump) of one Material of the materials map, relatively to the .obj directory (see queueTexture)
+/// @param mat Material to load the textures of
+void Model::loadMaterialTextures(Material& mat) {
+	if (!mat.mapKdPath.empty())
+		queueTexture(mat.name, &Material::diffuseTex, directory + "/" + mat.mapKdPath);
+	if (!mat.mapKsPath.empty())
+		queueTexture(mat.name, &Material::specularTex, directory + "/" + mat.mapKsPath);
+	if (!mat.mapBumpPath.empty())
+		queueTexture(mat.name, &Material::normalTex, directory + "/" + mat.mapBumpPath);
+}
 
-	// Load textures
-	for (auto& it : materials) {
-		auto& mat  = it.second;
-		if (!mat.mapKdPath.empty())
-			mat.diffuseTex.loadTexture(directory + "/" + mat.mapKdPath.c_str());
-		if (!mat.mapKsPath.empty())
-			mat.specularTex.loadTexture(directory + "/" + mat.mapKsPath.c_str());
-		if (!mat.mapBumpPath.empty())
-			mat.normalTex.loadTexture(directory + "/" + mat.mapBumpPath.c_str());
+/// @brief decode a texture on _texturePool, pollLoad uploads it on the GL thread once ready.
+///
+/// An image already loaded (TextureCache) or already being decoded for another Material is shared instead of being decoded again.
+/// Until then the Material texture id stays 0 and its Meshes are drawn with the flat diffuse color.
+/// @param material name of the Material in the materials map
+/// @param slot texture of the Material to set (diffuseTex, specularTex or normalTex)
+/// @param path image file path
+void Model::queueTexture(const std::string& material, Texture Material::* slot, const std::string& path) {
+	if ((materials[material].*slot).findCached(path))
+		return;
+	std::string resolved = TextureCache::resolvePath(path);
+	for (auto& pending : _pendingTextures) {
+		if (pending.path == resolved) {
+			pending.users.push_back({material, slot});
+			return;
+		}
+	}
+	if (!_texturePool)
+		_texturePool = std::make_unique<ThreadPool>();
+	_pendingTextures.push_back({resolved, {{material, slot}}, _texturePool->submit([path]() { return Texture::decode(path); })});
+}
+
+/// @brief upload the textures _texturePool is done decoding and give them to every Material waiting for them, release the pool once none is left
+/// @throw an exception if a texture could not be loaded
+void Model::uploadReadyTextures() {
+	for (auto it = _pendingTextures.begin(); it != _pendingTextures.end();) {
+		if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+		TextureImage image = it->image.get();
+		TextureTiming timing{image.path, image.width, image.height, image.decodeMs, image.mipMs, 0};
+		auto start = std::chrono::steady_clock::now();
+		Texture tex;
+		tex.upload(image);
+		timing.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		_textureTimings.push_back(timing);
+		for (auto& user : it->users)
+			materials[user.first].*(user.second) = tex;
+		_drawsChanged = true;
+		it = _pendingTextures.erase(it);
 	}
+	if (_pendingTextures.empty())
+		_texturePool.reset();
 }
 
 /// @brief utilitary function  that check if the file is a .obj and is longer that 4 (no ".obj" file only)
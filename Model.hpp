@@ -3,43 +3,56 @@
 #include <iostream>
 #include "header.h"
 #include "Shader.hpp"
+#include "ShaderVariants.hpp"
 #include "Mesh.hpp"
 #include "Includes/vml.hpp"
 #include "Includes/struct.hpp"
+#include "ObjTokenizer.hpp"
+#include "VertexCache.hpp"
+#include "ThreadPool.hpp"
+#include "TextureCache.hpp"
+#include "IndirectDraws.hpp"
+#include "RenderQueue.hpp"
+#include "UniformBuffers.hpp"
+#include "GLState.hpp"
 #include <unordered_map>
 #include <limits>
 #include <algorithm>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <future>
 
 
 using namespace vml;
 
 class Mesh;
+struct ModelStream;
 
-struct VertexKey {
-    int v, vt, vn;
-    bool operator==(VertexKey const& o) const noexcept {
-        return v == o.v && vt == o.vt && vn == o.vn;
-    }
-};
-struct VertexKeyHash {
-    size_t operator()(VertexKey const& k) const noexcept {
-        return static_cast<size_t>(
-            (k.v * 73856093) ^ (k.vt * 19349663) ^ (k.vn * 83492791)
-        );
-    }
-};
+// smallest chunk of the .obj worth handing to a worker of loadModelParallel
+static const size_t	OBJ_MIN_CHUNK_SIZE = 256 * 1024;
 
 class Model 
 {
 	public:
 		//constructors and destructors
 		Model();
-		Model(char *path);
+		Model(char *path, bool progressive = false);
 		Model& operator=(const Model& oth);
 		~Model();
 
 		// call function to draw each meshes in model
-		void Draw(Shader &shader);
+		void Draw(ShaderVariants &shaders);
+
+		//in ModelLoadAsync.cpp, progressive (background) loading and texture decoding
+		size_t	pollLoad();
+		bool	loading();
+		bool	streaming();
+		size_t	texturesPending();
+		size_t	bytesParsed();
+		size_t	bytesTotal();
 
 		void printMeshMatNames();
 		//getters
@@ -47,16 +60,45 @@ class Model
 		std::vector<Mesh> getMeshes();
 		vec3 min();
 		vec3 max();
+		bool fromCache();
+		const std::vector<TextureTiming>& textureTimings();
+		VertexCacheStats vertexCacheStats(bool optimized);
 	private:
 		// model data
 		std::vector<Mesh> meshes;
+		std::shared_ptr<MeshArena> _arena;	// GPU vertices and indices of every Mesh, created by the first upload (arena())
+		std::unique_ptr<IndirectDraws> _indirect;	// draw commands of every Mesh with setup.indirectDraw, null if they could not be built
+		bool _drawsChanged = true;	// Meshes or Material textures changed since _indirect was built
+		RenderQueue _queue;			// Meshes of the frame being drawn (Draw)
+		MaterialTable _materialTable;	// colours of the Materials, rebuilt when one is added (updateMaterialTable)
 		std::unordered_map<std::string, Material> materials;
 		std::string directory;
 		std::string _name;
+		std::vector<std::string> _sources;	// .obj and .mtl files the Model was built from (.scopbin cache key)
+		bool _fromCache = false;
+		std::unique_ptr<ModelStream> _stream;	// progressive load in progress (displayed Model side)
+		ModelStream* _sink = nullptr;			// set on the staging Model of a progressive load (worker side)
+
+		// image being decoded by _texturePool, uploaded by pollLoad once ready and given to each (Material name, texture) user
+		struct PendingTexture {
+			std::string												path;	// resolved image path
+			std::vector<std::pair<std::string, Texture Material::*>>	users;
+			std::future<TextureImage>								image;
+		};
+		std::unique_ptr<ThreadPool>	_texturePool;
+		std::vector<PendingTexture>	_pendingTextures;
+		std::vector<TextureTiming>	_textureTimings;	// one per texture uploaded, in upload order
 		vec3 _min = { +MAXFLOAT, +MAXFLOAT, +MAXFLOAT };
 		vec3 _max = { -MAXFLOAT, -MAXFLOAT, -MAXFLOAT };
 
 		void	loadMtl(std::string path);
+		void	loadMaterialTextures();
+		void	loadMaterialTextures(Material& mat);
+		void	queueTexture(const std::string& material, Texture Material::* slot, const std::string& path);
+		void	uploadReadyTextures();
+		const std::shared_ptr<MeshArena>&	arena();
+		bool	drawIndirect(ShaderVariants &shaders);
+		void	updateMaterialTable();
 		
 		//loader utils
 		void	defineMinMax(float x, float y, float z);
@@ -64,11 +106,53 @@ class Model
 		void	convertMtlPath(std::string& mtlpath);
 
 		//in ModelLoadObj.cpp
-		void	loadModel(std::string path);
+		void	loadModel(std::string path, bool progressive);
+		void	storeCache(const std::string& cachePath);
+		void	loadModelStream(std::string path);
+		//in ModelLoadObjMapped.cpp
+		void	loadModelMapped(std::string path);
+		//in ModelLoadObjParallel.cpp
+		void	loadModelParallel(std::string path, unsigned int threads, size_t minChunkSize = OBJ_MIN_CHUNK_SIZE);
+		//in ModelLoadAsync.cpp
+		void	startStream(std::string path, const std::string& cachePath);
+		void	streamWorker(std::string path);
+		void	reportProgress(size_t bytes);
+		void	publishMaterials(const std::vector<std::string>& names);
+		void	finishStream();
+		//in ModelCache.cpp
+		std::string	cacheFilePath(const std::string& path);
+		bool	loadCache(const std::string& cachePath);
+		void	writeCache(const std::string& cachePath);
 		
 		//loadObj sub functions
-		int		faceLineParse(std::stringstream& ss, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt,
-					std::vector<vec3>& temp_vn, Mesh& currentMesh, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache);
-		void	usemtl(std::stringstream& ss, Mesh& currentMesh, std::string& prevMat, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache);
-		void	finishAndResetMesh(Mesh& currentMesh, std::string prevMat, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache, bool reset);
+		int		faceLineParse(ObjCursor& line, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt, std::vector<vec3>& temp_vn,
+					Mesh& currentMesh, VertexCache& cache, std::vector<unsigned int>& faceIndices);
+		static VertexKey	faceVertexKey(int vId, int vtId, int vnId, size_t vCount, size_t vtCount, size_t vnCount);
+		unsigned int	cachedVertex(VertexKey key, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt,
+					std::vector<vec3>& temp_vn, Mesh& currentMesh, VertexCache& cache);
+		int		triangulateFace(const std::vector<unsigned int>& faceIndices, Mesh& currentMesh);
+		void	usemtl(std::string matName, Mesh& currentMesh, std::string& prevMat, VertexCache& cache);
+		void	finishAndResetMesh(Mesh& currentMesh, std::string prevMat, VertexCache& cache, bool reset);
+};
+
+/**
+ * @brief state shared by the worker thread of a progressive load and the GL thread (see ModelLoadAsync.cpp).
+ *
+ * The worker parses into a staging Model and publishes each Mesh as soon as its g/usemtl group is closed,
+ * already prepared (normals, UVs, optimized order) so the GL thread only has to upload it.
+ */
+struct ModelStream {
+	std::thread				worker;
+	std::unique_ptr<Model>	staging;
+	std::string				cachePath;
+	size_t					bytesTotal = 0;
+	std::atomic<size_t>		bytesParsed{0};
+	std::atomic<bool>		cancel{false};
+	std::atomic<bool>		done{false};
+
+	std::mutex				mutex;		// guards everything below
+	std::vector<Mesh>		meshes;		// prepared, not uploaded yet
+	std::vector<Material>	materials;	// parsed, textures not loaded yet
+	vec3					min, max;	// bounds when the last Mesh was published
+	std::exception_ptr		error;
 };
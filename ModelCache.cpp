@@ -0,0 +1,294 @@
+#include "Model.hpp"
+#include "MappedFile.hpp"
+
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+/*
+ * .scopbin layout (native endianness, every item starts on an 8 bytes boundary so arrays can be used in place from the mapping):
+ *
+ *	"SCOPBIN\0" | u32 version | u32 sizeof(Vertex) | u32 setup flags
+ *	u64 source count	| { string path | i64 size | i64 mtime(ns) }	.obj first, then each .mtl
+ *	string name | vec3 min | vec3 max
+ *	u64 material count	| { string name | vec3 ambient, diffuse, specular | float shininess, opacity | string map_Kd, map_Ks, map_Bump }
+ *	u64 mesh count		| { string name | string material | u32 flags | u64 n | Vertex[n] | u64 m | u32[m] }
+ *
+ *	string = u64 length + characters
+ */
+static const char			CACHE_MAGIC[8] = {'S', 'C', 'O', 'P', 'B', 'I', 'N', '\0'};
+static const uint32_t		CACHE_VERSION = 3;
+static const size_t			CACHE_ALIGN = 8;
+
+// options of setup the meshes of the cache were built with, a cache built with others is parsed again. --packed-vertices
+// is not one of them: the vertices are only packed by Mesh::upload, the cached meshes are the same with or without it
+enum cacheSetupFlags {
+	cacheOptimized = 1			// --no-mesh-opt not given: triangles and vertices reordered (MeshOptimize.hpp)
+};
+
+/// @brief Utilitary function returning the cacheSetupFlags of the current setup
+static uint32_t setupFlags() {
+	return setup.optimizeMeshes ? cacheOptimized : 0;
+}
+
+enum cacheMeshFlags {
+	cacheVnPresent = 1,
+	cacheVtPresent = 2
+};
+
+/// @brief Utilitary function returning the absolute, normalized version of a path (cache key)
+static std::string absolutePath(const std::string& path) {
+	std::error_code ec;
+	std::filesystem::path abs = std::filesystem::absolute(path, ec);
+	return ec ? path : abs.lexically_normal().string();
+}
+
+//________________ writing helpers, each item is padded to CACHE_ALIGN _____________________//
+
+static void writeRaw(std::ofstream& out, const void* data, size_t size) {
+	static const char zeros[CACHE_ALIGN] = {};
+	out.write(static_cast<const char*>(data), size);
+	size_t pad = (CACHE_ALIGN - static_cast<size_t>(out.tellp()) % CACHE_ALIGN) % CACHE_ALIGN;
+	out.write(zeros, pad);
+}
+
+template<typename T>
+static void writePod(std::ofstream& out, const T& value) {
+	writeRaw(out, &value, sizeof(T));
+}
+
+static void writeString(std::ofstream& out, const std::string& str) {
+	writePod<uint64_t>(out, str.size());
+	writeRaw(out, str.data(), str.size());
+}
+
+template<typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& arr) {
+	writePod<uint64_t>(out, arr.size());
+	writeRaw(out, arr.data(), arr.size() * sizeof(T));
+}
+
+/**
+ * @brief bounds-checked cursor over a mapped .scopbin. Any read past the end marks the reader as failed instead of throwing,
+ * a broken cache is only a reason to parse the .obj again.
+ */
+struct CacheReader {
+	const char*	base;
+	const char*	p;
+	const char*	end;
+	bool		ok = true;
+
+	const char* take(size_t size) {
+		if (!ok || size > static_cast<size_t>(end - p)) {
+			ok = false;
+			return nullptr;
+		}
+		const char* data = p;
+		size_t offset = (p - base) + size;
+		p = base + std::min(offset + (CACHE_ALIGN - offset % CACHE_ALIGN) % CACHE_ALIGN, static_cast<size_t>(end - base));
+		return data;
+	}
+	template<typename T>
+	T pod() {
+		T value{};
+		if (const char* data = take(sizeof(T)))
+			memcpy(&value, data, sizeof(T));
+		return value;
+	}
+	std::string string() {
+		uint64_t size = pod<uint64_t>();
+		const char* data = take(size);
+		return data ? std::string(data, size) : std::string();
+	}
+	template<typename T>
+	const T* array(uint64_t& count) {
+		count = pod<uint64_t>();
+		if (count > static_cast<uint64_t>(end - p) / sizeof(T)) {
+			ok = false;
+			return nullptr;
+		}
+		return reinterpret_cast<const T*>(take(count * sizeof(T)));
+	}
+};
+
+// mesh of the cache, arrays point into the mapping
+struct CachedMesh {
+	std::string			name;
+	std::string			material;
+	uint32_t			flags;
+	const Vertex*		vertices;
+	uint64_t			vertexCount;
+	const unsigned int*	indices;
+	uint64_t			indexCount;
+};
+
+/// @brief path of the .scopbin of a .obj: next to it (model.obj -> model.scopbin), or in setup.cacheDir named after the model and a hash of its absolute path
+/// @param path .obj location path
+/// @return the .scopbin path
+std::string Model::cacheFilePath(const std::string& path) {
+	if (setup.cacheDir.empty())
+		return path.substr(0, path.size() - 4) + ".scopbin";
+
+	// FNV-1a, stable from one run (and build) to the next
+	uint64_t hash = 1469598103934665603ull;
+	for (char c : absolutePath(path)) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+	return setup.cacheDir + "/" + std::filesystem::path(path).stem().string() + "-" + hex + ".scopbin";
+}
+
+/// @brief try to build the Model from its .scopbin: the cache must have the current version, Vertex layout and setup flags, be built from the same .obj
+/// and all its sources (.obj, .mtl) must have the same size and modification time. Vertices and indices are sent to the GPU straight from the mapping.
+/// @param cachePath .scopbin location path
+/// @return false if there is no valid cache (the Model is left untouched), true if the Model was loaded from it
+/// @throw an exception if a Material texture could not be loaded
+bool Model::loadCache(const std::string& cachePath) {
+	MappedFile file;
+	try {
+		file.open(cachePath);
+	} catch (std::exception&) {
+		return false;
+	}
+	CacheReader in{file.data(), file.data(), file.data() + file.size()};
+
+	const char* magic = in.take(sizeof(CACHE_MAGIC));
+	if (!magic || memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+		return false;
+	if (in.pod<uint32_t>() != CACHE_VERSION || in.pod<uint32_t>() != sizeof(Vertex) || in.pod<uint32_t>() != setupFlags())
+		return false;
+
+	std::vector<std::string> sources(in.pod<uint64_t>());
+	for (size_t i = 0; i < sources.size() && in.ok; i++) {
+		sources[i] = in.string();
+		int64_t size = in.pod<int64_t>(), mtime = in.pod<int64_t>();
+		int64_t curSize, curMtime;
+		if (!fileStamp(sources[i], curSize, curMtime) || curSize != size || curMtime != mtime)
+			return false;
+	}
+	if (!in.ok || sources.empty() || sources[0] != absolutePath(_sources[0]))
+		return false;
+
+	std::string name = in.string();
+	vec3 min = in.pod<vec3>(), max = in.pod<vec3>();
+
+	std::unordered_map<std::string, Material> mats;
+	uint64_t matCount = in.pod<uint64_t>();
+	for (uint64_t i = 0; i < matCount && in.ok; i++) {
+		Material mat;
+		mat.name = in.string();
+		mat.ambient = in.pod<vec3>();
+		mat.diffuse = in.pod<vec3>();
+		mat.specular = in.pod<vec3>();
+		mat.shininess = in.pod<float>();
+		mat.opacity = in.pod<float>();
+		mat.mapKdPath = in.string();
+		mat.mapKsPath = in.string();
+		mat.mapBumpPath = in.string();
+		mats[mat.name] = mat;
+	}
+
+	std::vector<CachedMesh> cached;
+	uint64_t meshCount = in.pod<uint64_t>();
+	for (uint64_t i = 0; i < meshCount && in.ok; i++) {
+		CachedMesh mesh;
+		mesh.name = in.string();
+		mesh.material = in.string();
+		mesh.flags = in.pod<uint32_t>();
+		mesh.vertices = in.array<Vertex>(mesh.vertexCount);
+		mesh.indices = in.array<unsigned int>(mesh.indexCount);
+		cached.push_back(mesh);
+	}
+	if (!in.ok)
+		return false;
+
+	// the whole cache is valid, build the Model
+	_name = name;
+	_min = min;
+	_max = max;
+	_sources = sources;
+	materials = mats;
+	loadMaterialTextures();
+	size_t vertexCount = 0, indexBytes = 0;
+	for (auto& c : cached) {
+		vertexCount += c.vertexCount;
+		indexBytes += c.indexCount * sizeof(unsigned int) + 3;	// at most, see MeshArena::append
+	}
+	arena()->reserve(vertexCount, indexBytes);
+	for (auto& c : cached) {
+		Mesh mesh;
+		mesh.name(c.name);
+		mesh.materialName(c.material);
+		mesh.vnPresent(c.flags & cacheVnPresent);
+		mesh.vtPresent(c.flags & cacheVtPresent);
+		mesh.upload(arena(), c.vertices, c.vertexCount, c.indices, c.indexCount);
+		meshes.push_back(mesh);
+	}
+	return true;
+}
+
+/// @brief write the loaded Model (final vertices and indices of each Mesh, Materials and bounds) in a .scopbin.
+///
+/// The file is written next to its final path then renamed, so a crash never leaves a half written cache behind.
+/// @param cachePath .scopbin location path
+/// @throw an exception if the file could not be written
+void Model::writeCache(const std::string& cachePath) {
+	std::filesystem::path dir = std::filesystem::path(cachePath).parent_path();
+	if (!dir.empty())
+		std::filesystem::create_directories(dir);
+
+	std::string tmpPath = cachePath + ".tmp";
+	std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		throw std::runtime_error("Error: Could not write cache file: " + cachePath);
+
+	writeRaw(out, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	writePod<uint32_t>(out, CACHE_VERSION);
+	writePod<uint32_t>(out, sizeof(Vertex));
+	writePod<uint32_t>(out, setupFlags());
+
+	writePod<uint64_t>(out, _sources.size());
+	for (auto& source : _sources) {
+		int64_t size = 0, mtime = 0;
+		fileStamp(source, size, mtime);
+		writeString(out, absolutePath(source));
+		writePod(out, size);
+		writePod(out, mtime);
+	}
+
+	writeString(out, _name);
+	writePod(out, _min);
+	writePod(out, _max);
+
+	writePod<uint64_t>(out, materials.size());
+	for (auto& it : materials) {
+		const Material& mat = it.second;
+		writeString(out, mat.name);
+		writePod(out, mat.ambient);
+		writePod(out, mat.diffuse);
+		writePod(out, mat.specular);
+		writePod(out, mat.shininess);
+		writePod(out, mat.opacity);
+		writeString(out, mat.mapKdPath);
+		writeString(out, mat.mapKsPath);
+		writeString(out, mat.mapBumpPath);
+	}
+
+	writePod<uint64_t>(out, meshes.size());
+	for (auto& mesh : meshes) {
+		writeString(out, mesh.name());
+		writeString(out, mesh.materialName());
+		writePod<uint32_t>(out, (mesh.vnPresent() ? cacheVnPresent : 0) | (mesh.vtPresent() ? cacheVtPresent : 0));
+		writeArray(out, mesh.vertices());
+		writeArray(out, mesh.indices());
+	}
+
+	out.close();
+	if (!out || std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("Error: Could not write cache file: " + cachePath);
+	}
+}
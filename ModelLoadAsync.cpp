@@ -0,0 +1,131 @@
+#include "Model.hpp"
+
+#include <filesystem>
+
+/// @brief start a progressive load: a staging Model parses the .obj on a worker thread and publishes its Meshes and Materials
+/// in a ModelStream as they are completed, pollLoad moves them into this Model on the GL thread.
+///
+/// The serial loaders are used (stream or mmap, never the parallel one) as they close each Mesh while reading the file,
+/// so the first group is on screen long before the whole file is parsed. Meshes are the same as with a blocking load.
+/// @param path .obj location path
+/// @param cachePath .scopbin written once the load is complete
+void Model::startStream(std::string path, const std::string& cachePath) {
+	std::error_code ec;
+	_stream = std::make_unique<ModelStream>();
+	_stream->cachePath = cachePath;
+	_stream->bytesTotal = std::filesystem::file_size(path, ec);
+	if (ec)
+		_stream->bytesTotal = 0;
+
+	_stream->staging = std::make_unique<Model>();
+	Model& staging = *_stream->staging;
+	staging._sink = _stream.get();
+	staging.directory = directory;
+	staging._sources = _sources;
+	_stream->worker = std::thread(&Model::streamWorker, &staging, path);
+}
+
+/// @brief worker thread body, run on the staging Model. Any error is kept for the GL thread to rethrow
+/// @param path .obj location path
+void Model::streamWorker(std::string path) {
+	try {
+		if (setup.loader == streamed)
+			loadModelStream(path);
+		else
+			loadModelMapped(path);
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(_sink->mutex);
+		_sink->error = std::current_exception();
+	}
+	_sink->done = true;
+}
+
+/// @brief called by the loaders of a staging Model for each line: update the parsed bytes count and stop the worker if the load was cancelled
+/// @param bytes bytes of the .obj parsed so far
+/// @throw an exception when the displayed Model is destroyed before the end of the load
+void Model::reportProgress(size_t bytes) {
+	_sink->bytesParsed.store(bytes, std::memory_order_relaxed);
+	if (_sink->cancel.load(std::memory_order_relaxed))
+		throw std::runtime_error("Error: Loading cancelled.");
+}
+
+/// @brief publish the Materials of a .mtl just parsed by a staging Model, without their textures
+/// @param names names of the Materials defined in the .mtl
+void Model::publishMaterials(const std::vector<std::string>& names) {
+	std::lock_guard<std::mutex> lock(_sink->mutex);
+	for (auto& name : names)
+		_sink->materials.push_back(materials[name]);
+}
+
+/// @brief GL thread side of the background loading, to call once per frame: upload the textures decoded since the last call and,
+/// for a progressive load, start decoding the textures of the new Materials, upload the new Meshes and, once the worker is done,
+/// take the Model name, bounds and sources and write the .scopbin cache.
+/// @return the number of Meshes added by this call
+/// @throw the exception that stopped the worker or a texture decoding, if any
+size_t Model::pollLoad() {
+	uploadReadyTextures();
+	if (!_stream)
+		return 0;
+
+	bool finished = _stream->done;
+	std::vector<Mesh> ready;
+	std::vector<Material> mats;
+	{
+		std::lock_guard<std::mutex> lock(_stream->mutex);
+		ready.swap(_stream->meshes);
+		mats.swap(_stream->materials);
+		if (!ready.empty()) {
+			_min = _stream->min;
+			_max = _stream->max;
+		}
+	}
+
+	if (!ready.empty() || !mats.empty())
+		_drawsChanged = true;
+	for (auto& mat : mats) {
+		if (materials.count(mat.name))
+			continue;
+		materials[mat.name] = mat;
+		loadMaterialTextures(materials[mat.name]);
+	}
+	for (auto& mesh : ready) {
+		mesh.upload(arena(), mesh.vertices().data(), mesh.vertices().size(), mesh.indices().data(), mesh.indices().size());
+		meshes.push_back(mesh);
+	}
+
+	if (finished)
+		finishStream();
+	return ready.size();
+}
+
+/// @brief end of a progressive load: join the worker, rethrow its error or take the last values of the staging Model and write the cache
+/// @throw the exception that stopped the worker, if any
+void Model::finishStream() {
+	_stream->worker.join();
+	std::unique_ptr<ModelStream> stream = std::move(_stream);
+	if (stream->error)
+		std::rethrow_exception(stream->error);
+
+	Model& staging = *stream->staging;
+	_name = staging._name;
+	_sources = staging._sources;
+	_min = staging._min;
+	_max = staging._max;
+	storeCache(stream->cachePath);
+}
+
+/// @brief true while a progressive load is running or textures are not uploaded yet
+bool Model::loading() {return _stream != nullptr || !_pendingTextures.empty();}
+
+/// @brief true while a progressive load is running or has Meshes left to upload
+bool Model::streaming() {return _stream != nullptr;}
+
+/// @brief number of textures still being decoded or waiting for their upload
+size_t Model::texturesPending() {return _pendingTextures.size();}
+
+/// @brief bytes of the .obj parsed so far by a progressive load, 0 when none is running
+size_t Model::bytesParsed() {return _stream ? _stream->bytesParsed.load(std::memory_order_relaxed) : 0;}
+
+/// @brief size of the .obj of a progressive load, 0 when none is running
+size_t Model::bytesTotal() {return _stream ? _stream->bytesTotal : 0;}
@@ -1,37 +1,7 @@
 #include "Model.hpp"
+#include "ThreadPool.hpp"
 
 
-/// @brief Utilitary function that parse face point line and split in the three variable
-/// @param token face point line with 1 to 3 values
-/// @param vId reference to the vertex position index for the current face point 
-/// @param vtId reference to the texture vertex index for the current face point 
-/// @param vnId reference to the normal vertex index for the current face point 
-static void parseFaceVertex(const std::string& token, int &vId, int &vtId, int &vnId)
-{
-	vId = vtId = vnId = 0;
-	size_t p1 = token.find('/');
-	if (p1 == std::string::npos) {
-		vId = std::stoi(token);
-		return;
-	}
-	size_t p2 = token.find('/', p1 + 1);
-	if (p2 == std::string::npos) {
-		vId = std::stoi(token.substr(0, p1));
-		std::string a = token.substr(p1 + 1);
-		if (!a.empty()) vtId = std::stoi(a);
-		return;
-	}
-	vId = std::stoi(token.substr(0, p1));
-	if (p2 == p1 + 1) {
-		std::string b = token.substr(p2 + 1);
-		if (!b.empty()) vnId = std::stoi(b);
-	} else {
-		vtId = std::stoi(token.substr(p1 + 1, p2 - p1 - 1));
-		std::string c = token.substr(p2 + 1);
-		if (!c.empty()) vnId = std::stoi(c);
-	}
-}
-
 /// @brief Utilitary function that correct the face index base to an array base
 /// @param id raw index
 /// @param size size of the array
@@ -45,13 +15,23 @@ inline int objIndexToZeroBased(int id, size_t size) {
 /// @brief Function called to finsih the mesh creation (calls the setupMesh function) and reset a new clear Mesh for the next one if needed/specified
 /// @param currentMesh reference to the Mesh object to finish/reset
 /// @param prevMat previous Material Name in case no material where used/set here
-/// @param cache hash map of the vertices hashes to clear in  case of reset 
+/// @param cache cache of the Mesh vertices to clear in case of reset 
 /// @param reset bollean value to set to true if Mesh need to be cleared
-void Model::finishAndResetMesh(Mesh& currentMesh, std::string prevMat, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache, bool reset) {
+void Model::finishAndResetMesh(Mesh& currentMesh, std::string prevMat, VertexCache& cache, bool reset) {
 	if (!currentMesh.vertices().empty()) {
 		if (currentMesh.materialName().empty()) currentMesh.materialName(prevMat);
-		currentMesh.setupMesh(_min, _max - _min);
-		meshes.push_back(currentMesh);
+		if (_sink) {
+			// progressive load: hand it to the GL thread, which uploads it (see pollLoad)
+			currentMesh.prepare(_min, _max - _min);
+			std::lock_guard<std::mutex> lock(_sink->mutex);
+			_sink->meshes.push_back(currentMesh);
+			_sink->min = _min;
+			_sink->max = _max;
+		}
+		else {
+			currentMesh.setupMesh(arena(), _min, _max - _min);
+			meshes.push_back(currentMesh);
+		}
 		if (reset){
 			currentMesh = Mesh();
 			cache.clear();
@@ -62,15 +42,13 @@ void Model::finishAndResetMesh(Mesh& currentMesh, std::string prevMat, std::unor
 /// @brief Subfunctiun of loadModel called when 'usemtl' is found in the .obj. Finish the current Mesh and set the Material Name to the new Mesh
 ///
 /// If material name contains a ':' char, parse it and only take part after it
-/// @param ss stringstream reference of the current line parsed
+/// @param matName Material Name read after 'usemtl'
 /// @param currentMesh Mesh reference of the current Mesh, finish and reset it
 /// @param prevMat string reference of the previous Material Name to change
 /// @param cache reference of cache to reset with the creation of a new Mesh
 /// @throw an exception when Material Name was not in .mtl file
-void Model::usemtl(std::stringstream& ss, Mesh& currentMesh, std::string& prevMat, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache) {
+void Model::usemtl(std::string matName, Mesh& currentMesh, std::string& prevMat, VertexCache& cache) {
 	finishAndResetMesh(currentMesh, prevMat, cache, true);
-	std::string matName;
-	ss >> matName;
 	if (matName.find_last_of(":") < matName.size())
 		matName = matName.substr(matName.find_last_of(":") + 1);
 	if (materials.count(matName) == 0) {
@@ -80,58 +58,59 @@ void Model::usemtl(std::stringstream& ss, Mesh& currentMesh, std::string& prevMa
 	prevMat = matName;
 }
 
-/// @brief loadModel subfunction for the 'f' Face line parsing found in the .obj. 
-///
-/// Parse each point in 3 variables (Position, Texture, and Normal indices), rebase each index, check if Vertex already in cache for duplicates and push it to the Mesh indices.
-/// Final part handles non triangle faces by adding more triangle faces index for each additional points.
-/// @param ss coucou
+/// @brief Rebase the raw face point indices against the number of v, vt and vn read so far in the file
+/// @param vId raw position (v) index of the face point
+/// @param vtId raw texture (vt) index of the face point, 0 if absent
+/// @param vnId raw normal (vn) index of the face point, 0 if absent
+/// @param vCount number of position (v) points read before the face
+/// @param vtCount number of texture (vt) points read before the face
+/// @param vnCount number of normal (vn) points read before the face
+/// @return the 0-based key of the face point, vt and vn are negative when absent
+/// @throw an exception when position index out of range
+VertexKey Model::faceVertexKey(int vId, int vtId, int vnId, size_t vCount, size_t vtCount, size_t vnCount) {
+	// Map negative indices to 0-based
+	int vIndex  = objIndexToZeroBased(vId,  vCount);
+	int vtIndex = objIndexToZeroBased(vtId, vtCount);
+	int vnIndex = objIndexToZeroBased(vnId, vnCount);
+
+	if (vIndex < 0 || vIndex >= static_cast<int>(vCount))
+		throw std::runtime_error("OBJ parse error: vertex index out of range");
+
+	return VertexKey { vIndex, vtIndex, vnIndex };
+}
+
+/// @brief Check if the Vertex of a face point is already in the cache for duplicates or create it
+/// @param key 0-based indices of the face point (see faceVertexKey)
 /// @param temp_v reference of vector with all position (v) point parsed yet
 /// @param temp_vt reference of vector with all texture (vt) point parsed yet
 /// @param temp_vn reference of vector with all Normal (vn) point parsed yet
-/// @param currentMesh reference of the Mesh to push the new values to
-/// @param cache reference of the hash map to check and updates current and new values
-/// @return when not enough points in Mesh to check for non triangle faces, end prematurely and return 0, else 1
-/// @throw an exception when index out of range
-int Model::faceLineParse(std::stringstream& ss, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt,
-	std::vector<vec3>& temp_vn, Mesh& currentMesh, std::unordered_map<VertexKey, unsigned int, VertexKeyHash>& cache) {
-	// collect face tokens, convert to indices (with dedup)
-	std::vector<unsigned int> faceIndices;
-	std::string token;
-	while (ss >> token) {
-		int vId=0, vtId=0, vnId=0;
-		parseFaceVertex(token, vId, vtId, vnId);
+/// @param currentMesh reference of the Mesh to push the new Vertex to
+/// @param cache reference of the vertex cache to look the key up in and insert it if new
+/// @return the index of the Vertex in the Mesh
+unsigned int Model::cachedVertex(VertexKey key, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt,
+	std::vector<vec3>& temp_vn, Mesh& currentMesh, VertexCache& cache) {
+	unsigned int candidate = static_cast<unsigned int>(currentMesh.vertices().size());
+	unsigned int finalIndex = cache.findOrInsert(key, candidate);
+	if (finalIndex != candidate)
+		return finalIndex;
 
-		// Map negative indices to 0-based
-		int vIndex  = objIndexToZeroBased(vId,  temp_v.size());
-		int vtIndex = objIndexToZeroBased(vtId, temp_vt.size());
-		int vnIndex = objIndexToZeroBased(vnId, temp_vn.size());
-
-		if (vIndex < 0 || vIndex >= static_cast<int>(temp_v.size()))
-			throw std::runtime_error("OBJ parse error: vertex index out of range");
-
-		VertexKey key { vIndex, vtIndex, vnIndex };
-
-		unsigned int finalIndex;
-		auto it = cache.find(key);
-		if (it != cache.end()) {
-			finalIndex = it->second;
-		} else {
-			// create new vertex
-			Vertex vert;
-			vert.Position = temp_v[vIndex];
-			if (vtIndex >= 0) vert.TexCoords = temp_vt[vtIndex];
-			else vert.TexCoords = vec2{0.0f, 0.0f};
-			if (vnIndex >= 0) vert.Normal = temp_vn[vnIndex];
-			else vert.Normal = vec3{0.0f, 0.0f};
-
-			currentMesh.vertices().push_back(vert);
-			finalIndex = static_cast<unsigned int>(currentMesh.vertices().size() - 1);
-			cache.emplace(key, finalIndex);
-		}
-		faceIndices.push_back(finalIndex);
-	}
+	// create new vertex
+	Vertex vert;
+	vert.Position = temp_v[key.v];
+	if (key.vt >= 0) vert.TexCoords = temp_vt[key.vt];
+	else vert.TexCoords = vec2{0.0f, 0.0f};
+	if (key.vn >= 0) vert.Normal = temp_vn[key.vn];
+	else vert.Normal = vec3{0.0f, 0.0f};
 
-	// triangulate the face using fan (0,i,i+1)
+	currentMesh.vertices().push_back(vert);
+	return finalIndex;
+}
+
+/// @brief triangulate the face using fan (0,i,i+1) and push the triangles to the Mesh indices
+/// @param faceIndices Mesh indices of each point of the face
+/// @param currentMesh reference of the Mesh to push the new indices to
+/// @return when not enough points in the face, end prematurely and return 0, else 1
+int Model::triangulateFace(const std::vector<unsigned int>& faceIndices, Mesh& currentMesh) {
 	if (faceIndices.size() < 3) {
 		// ignore lines with less than 3 vertices
 		return 0;
@@ -144,14 +123,86 @@ int Model::faceLineParse(std::stringstream& ss, std::vector<vec3>& temp_v, std::
 	return 1;
 }
 
+/// @brief loadModel subfunction for the 'f' Face line parsing found in the .obj, shared by every loader.
+///
+/// Parse each point in 3 variables (Position, Texture, and Normal indices), rebase each index, check if Vertex already in cache for duplicates and push it to the Mesh indices.
+/// Final part handles non triangle faces by adding more triangle faces index for each additional points.
+/// @param line cursor over the rest of the line
+/// @param temp_v reference of vector with all position (v) point parsed yet
+/// @param temp_vt reference of vector with all texture (vt) point parsed yet
+/// @param temp_vn reference of vector with all Normal (vn) point parsed yet
+/// @param currentMesh reference of the Mesh to push the new values to
+/// @param cache reference of the vertex cache to look the key up in and insert it if new
+/// @param faceIndices scratch vector reused from one face to the next
+/// @return when not enough points in Mesh to check for non triangle faces, end prematurely and return 0, else 1
+/// @throw an exception when index out of range or invalid
+int Model::faceLineParse(ObjCursor& line, std::vector<vec3>& temp_v, std::vector<vec2>& temp_vt, std::vector<vec3>& temp_vn,
+	Mesh& currentMesh, VertexCache& cache, std::vector<unsigned int>& faceIndices) {
+	// collect face tokens, convert to indices (with dedup)
+	faceIndices.clear();
+	for (std::string_view token = line.token(); !token.empty(); token = line.token()) {
+		int vId=0, vtId=0, vnId=0;
+		parseFaceVertex(token, vId, vtId, vnId);
+		VertexKey key = faceVertexKey(vId, vtId, vnId, temp_v.size(), temp_vt.size(), temp_vn.size());
+		faceIndices.push_back(cachedVertex(key, temp_v, temp_vt, temp_vn, currentMesh, cache));
+	}
+	return triangulateFace(faceIndices, currentMesh);
+}
+
 /// @brief Main function of the Model creation that parse and load the .obj file in it to Create each Meshes (Vertices and Faces) and Materials needed.
 ///
 /// Will parse for lines with: mtllib, usemtl, o (not properly), g, v, vt, vn, f. Create a new mesh for each g and/or usemtl (check that Vertices are in Mesh to double check if a new mesh need to be created)
+/// The parsing itself is done by loadModelStream, loadModelMapped or loadModelParallel depending on setup.loader and setup.loaderThreads, all give the same Meshes and Materials.
+/// Unless setup.useCache is false, the result is read from / written to a .scopbin cache (see ModelCache.cpp) so the .obj is only parsed when it changed.
 /// @param path .obj location path
-void Model::loadModel(std::string path) {
+/// @param progressive parse on a worker thread and return right away, see startStream (a valid cache is still read right here)
+void Model::loadModel(std::string path, bool progressive) {
 	if (!validObjPath(path))
 		throw std::runtime_error("Error: Invalid file name/extension.");
 
+	directory = path.substr(0, path.find_last_of("/"));
+	meshes.clear();
+	materials.clear();
+	_sources = {path};
+
+	std::string cachePath = cacheFilePath(path);
+	if (setup.useCache && loadCache(cachePath)) {
+		_fromCache = true;
+		return;
+	}
+
+	if (progressive) {
+		startStream(path, cachePath);
+		return;
+	}
+
+	unsigned int threads = setup.loaderThreads ? setup.loaderThreads : ThreadPool::hardwareThreads();
+	if (setup.loader == streamed)
+		loadModelStream(path);
+	else if (threads > 1)
+		loadModelParallel(path, threads);
+	else
+		loadModelMapped(path);
+
+	storeCache(cachePath);
+}
+
+/// @brief write the .scopbin of the freshly parsed Model, unless setup.useCache is false. A failure is only reported on std::cerr
+/// @param cachePath .scopbin location path
+void Model::storeCache(const std::string& cachePath) {
+	if (!setup.useCache)
+		return;
+	try {
+		writeCache(cachePath);
+	} catch (std::exception& e) {
+		// not fatal, the next launch will parse the .obj again
+		std::cerr << e.what() << std::endl;
+	}
+}
+
+/// @brief original loader: read the .obj line by line with std::getline and a std::stringstream per line
+/// @param path .obj location path
+void Model::loadModelStream(std::string path) {
 	std::ifstream file(path);
 	if (!file.is_open())
 		throw std::runtime_error("Error: Object File could not be opened or does not exist.");
@@ -163,15 +214,15 @@ void Model::loadModel(std::string path) {
 	float x, y, z;
 	Mesh currentMesh;
 
-	directory = path.substr(0, path.find_last_of("/"));
-	meshes.clear();
-	materials.clear();
-
 	std::string line;
 
-	std::unordered_map<VertexKey, unsigned int, VertexKeyHash> cache;
+	VertexCache cache;
+	std::vector<unsigned int> faceIndices;
+	size_t bytes = 0;
 
 	while (std::getline(file, line)) {
+		bytes += line.size() + 1;
+		if (_sink) reportProgress(bytes);
 		if (line.empty()) continue;
 		std::stringstream ss(line);
 		std::string type;
@@ -194,13 +245,11 @@ void Model::loadModel(std::string path) {
 			temp_vn.push_back({x,y,z});
 		}
 		else if (type == "f") {
-			try {
-				if (!faceLineParse(ss, temp_v, temp_vt, temp_vn, currentMesh, cache))
-					continue;
-			}
-			catch (std::exception&e) {
-				throw;
-			}
+			// the points are tokenized in place, like the other loaders do
+			ObjCursor points{line.data(), line.data() + line.size()};
+			points.token();
+			if (!faceLineParse(points, temp_v, temp_vt, temp_vn, currentMesh, cache, faceIndices))
+				continue;
 		}
 		else if (type == "g") {
 			finishAndResetMesh(currentMesh, prevMat, cache, true);
@@ -212,7 +261,9 @@ void Model::loadModel(std::string path) {
 			ss >> _name;
 		}
 		else if (type == "usemtl") {
-			usemtl(ss, currentMesh, prevMat, cache);
+			std::string matName;
+			ss >> matName;
+			usemtl(matName, currentMesh, prevMat, cache);
 		}
 		else if (type == "mtllib") {
 			std::string mtlpath;
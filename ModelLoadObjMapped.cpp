@@ -0,0 +1,70 @@
+#include "Model.hpp"
+#include "MappedFile.hpp"
+#include "ObjTokenizer.hpp"
+
+
+/// @brief mmap the .obj and tokenize it in place: no line copy, no stringstream, numbers read with std::from_chars.
+///
+/// Same records and same Mesh splitting as loadModelStream, so both give the same Meshes and Materials.
+/// @param path .obj location path
+/// @throw an exception if the file could not be mapped, on invalid face index or unknown Material
+void Model::loadModelMapped(std::string path) {
+	MappedFile file(path);
+
+	std::vector<vec3> temp_v;
+	std::vector<vec3> temp_vn;
+	std::vector<vec2> temp_vt;
+	std::vector<unsigned int> faceIndices;
+	std::string prevMat;
+	float x, y, z;
+	Mesh currentMesh;
+
+	VertexCache cache;
+
+	const char* p = file.data();
+	const char* end = p + file.size();
+	while (p < end) {
+		ObjCursor line = nextLine(p, end);
+		if (_sink) reportProgress(p - file.data());
+		std::string_view type = line.token();
+		if (type.empty() || type[0] == '#') continue;
+
+		if (type == "v") {
+			line.number(x); line.number(y); line.number(z);
+			temp_v.push_back({x,y,z});
+			defineMinMax(x, y, z);
+		}
+		else if (type == "vt") {
+			line.number(x); line.number(y);
+			temp_vt.push_back({x,y});
+			currentMesh.vtPresent(true);
+		}
+		else if (type == "vn") {
+			currentMesh.vnPresent(true);
+			line.number(x); line.number(y); line.number(z);
+			temp_vn.push_back({x,y,z});
+		}
+		else if (type == "f") {
+			faceLineParse(line, temp_v, temp_vt, temp_vn, currentMesh, cache, faceIndices);
+		}
+		else if (type == "g") {
+			finishAndResetMesh(currentMesh, prevMat, cache, true);
+			currentMesh.name(std::string(line.token()));
+		}
+		else if (type == "o") {
+			std::string_view name = line.token();
+			if (!name.empty())
+				_name = name;
+		}
+		else if (type == "usemtl") {
+			usemtl(std::string(line.token()), currentMesh, prevMat, cache);
+		}
+		else if (type == "mtllib") {
+			std::string mtlpath(line.token());
+			convertMtlPath(mtlpath);
+			loadMtl(mtlpath);
+		}
+	}
+
+	finishAndResetMesh(currentMesh, prevMat, cache, false);
+}
@@ -0,0 +1,227 @@
+#include "Model.hpp"
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+// records kept by a chunk, in file order, for the serial replay
+enum objRecordType {
+	recV,		// run of 'v' lines
+	recVt,		// run of 'vt' lines
+	recVn,		// run of 'vn' lines
+	recFace,	// run of 'f' lines
+	recGroup,	// 'g'
+	recObject,	// 'o'
+	recUsemtl,	// 'usemtl'
+	recMtllib	// 'mtllib'
+};
+
+struct ObjRecord {
+	objRecordType		type;
+	unsigned int		count;	// number of lines of a run
+	std::string_view	name;	// argument of g, o, usemtl and mtllib (view into the mapped file)
+};
+
+/**
+ * @brief everything parsed out of one newline-aligned part of the .obj.
+ *
+ * Values are stored as read: face points keep their raw (1-based or negative) indices as their meaning depends on
+ * the number of v/vt/vn read before them in the whole file, which is only known once the previous chunks are done.
+ */
+struct ObjChunk {
+	std::vector<vec3>			v;
+	std::vector<vec2>			vt;
+	std::vector<vec3>			vn;
+	std::vector<int>			points;		// v, vt, vn raw indices of each face point
+	std::vector<unsigned int>	faceSizes;	// number of points of each face
+	std::vector<ObjRecord>		records;
+};
+
+/// @brief add a line to the current run of this type or start a new run
+/// @param chunk chunk to add the record to
+/// @param type record type of the line
+static void addRun(ObjChunk& chunk, objRecordType type) {
+	if (!chunk.records.empty() && chunk.records.back().type == type)
+		chunk.records.back().count++;
+	else
+		chunk.records.push_back({type, 1, {}});
+}
+
+/// @brief worker task: tokenize a range of whole lines into a chunk (numbers and face indices, no deduplication)
+/// @param p start of the first line of the chunk
+/// @param end end of the chunk (just after a '\n' or end of file)
+/// @param chunk chunk to fill
+/// @throw an exception on invalid face index
+static void parseChunk(const char* p, const char* end, ObjChunk& chunk) {
+	float x, y, z;
+
+	while (p < end) {
+		ObjCursor line = nextLine(p, end);
+		std::string_view type = line.token();
+		if (type.empty() || type[0] == '#') continue;
+
+		if (type == "v") {
+			line.number(x); line.number(y); line.number(z);
+			chunk.v.push_back({x,y,z});
+			addRun(chunk, recV);
+		}
+		else if (type == "vt") {
+			line.number(x); line.number(y);
+			chunk.vt.push_back({x,y});
+			addRun(chunk, recVt);
+		}
+		else if (type == "vn") {
+			line.number(x); line.number(y); line.number(z);
+			chunk.vn.push_back({x,y,z});
+			addRun(chunk, recVn);
+		}
+		else if (type == "f") {
+			unsigned int size = 0;
+			for (std::string_view token = line.token(); !token.empty(); token = line.token()) {
+				int vId=0, vtId=0, vnId=0;
+				parseFaceVertex(token, vId, vtId, vnId);
+				chunk.points.push_back(vId);
+				chunk.points.push_back(vtId);
+				chunk.points.push_back(vnId);
+				size++;
+			}
+			chunk.faceSizes.push_back(size);
+			addRun(chunk, recFace);
+		}
+		else if (type == "g")
+			chunk.records.push_back({recGroup, 1, line.token()});
+		else if (type == "o")
+			chunk.records.push_back({recObject, 1, line.token()});
+		else if (type == "usemtl")
+			chunk.records.push_back({recUsemtl, 1, line.token()});
+		else if (type == "mtllib")
+			chunk.records.push_back({recMtllib, 1, line.token()});
+	}
+}
+
+/// @brief append a chunk values to the whole file ones and free them from the chunk
+/// @param all values of the whole file
+/// @param part values of the chunk
+template<typename T>
+static void moveAppend(std::vector<T>& all, std::vector<T>& part) {
+	all.insert(all.end(), part.begin(), part.end());
+	std::vector<T>().swap(part);
+}
+
+/// @brief parallel version of loadModelMapped: the mapped .obj is cut in newline-aligned chunks tokenized on a ThreadPool,
+/// then the chunks records are replayed in file order on this thread.
+///
+/// The replay does exactly what the serial loader does for each line (min/max, index rebasing against the counts read so far,
+/// deduplication, Mesh splitting on g/usemtl) so the Meshes are bit-identical to the serial ones whatever the number of threads.
+///
+/// Errors are reported in the order they are found, not in file order: an invalid face point of any chunk stops the load
+/// before the replay, so it wins over an unknown Material or an out of range index of an earlier line, which the serial
+/// loaders would report first.
+/// @param path .obj location path
+/// @param threads number of worker threads
+/// @param minChunkSize smallest chunk handed to a worker (tests cut small files in many chunks with 1)
+/// @throw an exception if the file could not be mapped, on invalid face index or unknown Material
+void Model::loadModelParallel(std::string path, unsigned int threads, size_t minChunkSize) {
+	MappedFile file(path);
+	const char* data = file.data();
+	size_t size = file.size();
+
+	// a few chunks per thread to even out the work, none smaller than minChunkSize
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads * 4, size / std::max<size_t>(1, minChunkSize)));
+	std::vector<ObjChunk> chunks(chunkCount);
+	std::vector<std::future<void>> parsed;
+	{
+		ThreadPool pool(std::min<size_t>(threads, chunkCount));
+		const char* start = data;
+		for (size_t i = 0; i < chunkCount; i++) {
+			const char* end = data + size;
+			if (i + 1 < chunkCount) {
+				end = std::max(start, data + size * (i + 1) / chunkCount);
+				const char* eol = static_cast<const char*>(memchr(end, '\n', data + size - end));
+				end = eol ? eol + 1 : data + size;
+			}
+			ObjChunk& chunk = chunks[i];
+			parsed.push_back(pool.submit([start, end, &chunk]() { parseChunk(start, end, chunk); }));
+			start = end;
+		}
+		// rethrow the first error in file order
+		for (auto& f : parsed)
+			f.get();
+	}
+
+	std::vector<vec3> temp_v;
+	std::vector<vec3> temp_vn;
+	std::vector<vec2> temp_vt;
+	size_t vCount = 0, vtCount = 0, vnCount = 0;
+	for (auto& chunk : chunks) {
+		vCount += chunk.v.size();
+		vtCount += chunk.vt.size();
+		vnCount += chunk.vn.size();
+	}
+	temp_v.reserve(vCount);
+	temp_vt.reserve(vtCount);
+	temp_vn.reserve(vnCount);
+	for (auto& chunk : chunks) {
+		moveAppend(temp_v, chunk.v);
+		moveAppend(temp_vt, chunk.vt);
+		moveAppend(temp_vn, chunk.vn);
+	}
+
+	// replay, vCount/vtCount/vnCount are now the number of values read so far
+	std::vector<unsigned int> faceIndices;
+	std::string prevMat;
+	Mesh currentMesh;
+	// a Mesh has at most as many distinct vertices as the file has positions, most of the time about that many
+	VertexCache cache(temp_v.size());
+	vCount = vtCount = vnCount = 0;
+
+	for (auto& chunk : chunks) {
+		const int* point = chunk.points.data();
+		const unsigned int* faceSize = chunk.faceSizes.data();
+
+		for (const ObjRecord& rec : chunk.records) {
+			switch (rec.type) {
+				case recV:
+					for (unsigned int i = 0; i < rec.count; i++, vCount++)
+						defineMinMax(temp_v[vCount][0], temp_v[vCount][1], temp_v[vCount][2]);
+					break;
+				case recVt:
+					vtCount += rec.count;
+					currentMesh.vtPresent(true);
+					break;
+				case recVn:
+					vnCount += rec.count;
+					currentMesh.vnPresent(true);
+					break;
+				case recFace:
+					for (unsigned int i = 0; i < rec.count; i++, faceSize++) {
+						faceIndices.clear();
+						for (unsigned int j = 0; j < *faceSize; j++, point += 3) {
+							VertexKey key = faceVertexKey(point[0], point[1], point[2], vCount, vtCount, vnCount);
+							faceIndices.push_back(cachedVertex(key, temp_v, temp_vt, temp_vn, currentMesh, cache));
+						}
+						triangulateFace(faceIndices, currentMesh);
+					}
+					break;
+				case recGroup:
+					finishAndResetMesh(currentMesh, prevMat, cache, true);
+					currentMesh.name(std::string(rec.name));
+					break;
+				case recObject:
+					if (!rec.name.empty())
+						_name = rec.name;
+					break;
+				case recUsemtl:
+					usemtl(std::string(rec.name), currentMesh, prevMat, cache);
+					break;
+				case recMtllib: {
+					std::string mtlpath(rec.name);
+					convertMtlPath(mtlpath);
+					loadMtl(mtlpath);
+					break;
+				}
+			}
+		}
+		std::vector<int>().swap(chunk.points);
+	}
+
+	finishAndResetMesh(currentMesh, prevMat, cache, false);
+}
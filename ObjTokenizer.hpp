@@ -0,0 +1,132 @@
+#pragma once
+
+#include <charconv>
+#include <string_view>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+/**
+ * @brief string_view-style cursor over a range of characters (a line of a mapped .obj/.mtl).
+ *
+ * Nothing is copied or allocated: tokens are views into the underlying bytes and numbers are read with std::from_chars.
+ * Spaces, tabs and '\r' are treated as separators, like the stream extraction operator does.
+ */
+struct ObjCursor {
+	const char* p;
+	const char* end;
+
+	static bool isSpace(char c) {return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';}
+
+	bool atEnd() {
+		skipSpaces();
+		return p >= end;
+	}
+
+	void skipSpaces() {
+		while (p < end && isSpace(*p))
+			++p;
+	}
+
+	/// @brief next whitespace delimited token, empty view when the line is consumed
+	std::string_view token() {
+		skipSpaces();
+		const char* start = p;
+		while (p < end && !isSpace(*p))
+			++p;
+		return std::string_view(start, p - start);
+	}
+
+	/// @brief read the next float of the line, out is set to 0 if there is none
+	/// @return false when no number could be read
+	bool number(float& out) {
+		skipSpaces();
+		if (p < end && *p == '+')
+			++p;
+		auto res = std::from_chars(p, end, out);
+		if (res.ec != std::errc()) {
+			out = 0.0f;
+			return false;
+		}
+		p = res.ptr;
+		return true;
+	}
+
+	/// @brief read the next integer of the line, out is set to 0 if there is none
+	/// @return false when no number could be read
+	bool number(int& out) {
+		skipSpaces();
+		if (p < end && *p == '+')
+			++p;
+		auto res = std::from_chars(p, end, out);
+		if (res.ec != std::errc()) {
+			out = 0;
+			return false;
+		}
+		p = res.ptr;
+		return true;
+	}
+};
+
+/// @brief cut the next line out of a mapped buffer and advance the cursor past its '\n'
+/// @param p reference to the current position in the buffer, moved to the start of the next line
+/// @param end end of the buffer
+/// @return a cursor over the line, without the '\n'
+inline ObjCursor nextLine(const char*& p, const char* end) {
+	const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+	if (!eol)
+		eol = end;
+	ObjCursor line{p, eol};
+	p = eol < end ? eol + 1 : end;
+	return line;
+}
+
+/// @brief Utilitary function that read a face point index with std::from_chars, the same way std::stoi would: leading part of the
+/// characters, an optional '+' sign, anything after the number up to the next '/' is ignored
+/// @param p reference to the start of the index, moved to the next '/' (or end)
+/// @param end end of the face point token
+/// @return the index read
+/// @throw an exception when no index could be read or it does not fit an int
+inline int faceIndexToInt(const char*& p, const char* end) {
+	const char* start = p;
+	if (p < end && *p == '+' && p + 1 < end && *(p + 1) != '-')
+		++p;
+	int id = 0;
+	auto res = std::from_chars(p, end, id);
+	if (res.ec != std::errc()) {
+		const char* slash = static_cast<const char*>(memchr(start, '/', end - start));
+		throw std::runtime_error("OBJ parse error: invalid face index: " + std::string(start, slash ? slash : end));
+	}
+	p = res.ptr;
+	if (p < end && *p != '/') {
+		const char* slash = static_cast<const char*>(memchr(p, '/', end - p));
+		p = slash ? slash : end;
+	}
+	return id;
+}
+
+/// @brief split a face point token in its three indices in a single pass, without any allocation
+/// @param token face point with 1 to 3 values (v, v/vt, v//vn, v/vt/vn), a missing or empty value is left to 0
+/// @param vId reference to the vertex position index for the current face point
+/// @param vtId reference to the texture vertex index for the current face point
+/// @param vnId reference to the normal vertex index for the current face point
+/// @throw an exception when an index is present but invalid
+inline void parseFaceVertex(std::string_view token, int &vId, int &vtId, int &vnId)
+{
+	const char* p = token.data();
+	const char* end = p + token.size();
+
+	vId = vtId = vnId = 0;
+	vId = faceIndexToInt(p, end);
+	if (p == end || ++p == end)		// "v" or "v/"
+		return;
+	if (*p != '/') {
+		vtId = faceIndexToInt(p, end);
+		if (p == end || ++p == end)	// "v/vt" or "v/vt/"
+			return;
+	}
+	else
+		++p;						// "v//vn"
+	if (p < end)
+		vnId = faceIndexToInt(p, end);
+}
@@ -0,0 +1,153 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+//________________ Scope _____________________//
+
+/// @brief start timing a section, and its GL_TIME_ELAPSED query if gpu (at most one gpu Scope at a time)
+/// @param section part of the frame the time is added to
+/// @param gpu also time the GL commands issued until the end of the Scope
+Profiler::Scope::Scope(ProfileSection section, bool gpu) : _section(section), _gpu(gpu) {
+	if (_gpu)
+		Profiler::instance().beginQuery(_section);
+	_start = clock::now();
+}
+
+/// @brief add the time since the construction to the section in the current frame
+Profiler::Scope::~Scope() {
+	std::chrono::duration<float, std::milli> elapsed = clock::now() - _start;
+	Profiler& profiler = Profiler::instance();
+	FrameRecord& frame = profiler.current();
+	frame.cpuMs[_section] += elapsed.count();
+	if (_section == PROFILE_MESHES)
+		frame.meshes++;
+	if (_gpu)
+		profiler.endQuery(_section);
+}
+
+//________________ Profiler _____________________//
+
+/// @brief the profiler of the render loop
+Profiler& Profiler::instance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+/// @brief name of a section, as shown in the panel and the CSV header
+const char* Profiler::name(ProfileSection section) {
+	static const char* names[PROFILE_SECTION_COUNT] = {"input", "matrices", "draw", "meshes", "ui", "swap"};
+	return names[section];
+}
+
+/// @brief close the previous frame (its length and GL calls, to call before GLState::beginFrame) and start a new one, reading
+/// the queries of the frame two before if their results are available
+void Profiler::beginFrame() {
+	clock::time_point now = clock::now();
+	if (_frame) {
+		std::chrono::duration<float, std::milli> elapsed = now - _frameStart;
+		current().frameMs = elapsed.count();
+		current().calls = GLState::instance().stats();
+	}
+	_frameStart = now;
+	_frame++;
+	FrameRecord& frame = current();
+	frame = FrameRecord();
+	frame.index = _frame - 1;
+	for (float& gpu : frame.gpuMs)
+		gpu = -1.f;
+	// the set of queries of the new frame is the one of the frame two before
+	if (_frame > QUERY_SETS)
+		readQueries((_frame - 1) % QUERY_SETS, _frame - 1 - QUERY_SETS);
+}
+
+/// @brief delete the queries, to call while the GL context still exists
+void Profiler::release() {
+	for (size_t set = 0; set < QUERY_SETS; set++) {
+		if (_queries[set][0])
+			glDeleteQueries(PROFILE_SECTION_COUNT, _queries[set]);
+		for (size_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+			_queries[set][i] = 0;
+			_issued[set][i] = false;
+		}
+	}
+}
+
+/**
+ * @brief write the frames kept, oldest first, one line each: frame length, CPU and GPU time of every section (-1 for no
+ * GPU time) and the GL counters. Not fatal, the error is reported on std::cerr
+ * @param path CSV file, overwritten
+ * @return false if the file could not be written
+ */
+bool Profiler::dumpCsv(const std::string& path) const {
+	std::ofstream out(path, std::ios::trunc);
+	if (out.is_open()) {
+		out << "frame,frame_ms";
+		for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+			out << "," << name(static_cast<ProfileSection>(s)) << "_cpu_ms";
+		for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+			out << "," << name(static_cast<ProfileSection>(s)) << "_gpu_ms";
+		out << ",meshes,gl_calls,draws,triangles,state_changes,uniforms,skipped\n";
+		for (size_t age = frames(); age-- > 0;) {
+			const FrameRecord& frame = record(age);
+			out << frame.index << "," << frame.frameMs;
+			for (float ms : frame.cpuMs)
+				out << "," << ms;
+			for (float ms : frame.gpuMs)
+				out << "," << ms;
+			out << "," << frame.meshes << "," << frame.calls.calls << "," << frame.calls.draws << "," << frame.calls.triangles
+				<< "," << frame.calls.stateChanges << "," << frame.calls.uniforms << "," << frame.calls.skipped << "\n";
+		}
+		out.close();
+		if (out)
+			return true;
+	}
+	std::cerr << "Error: Could not write profiler CSV file: " << path << std::endl;
+	return false;
+}
+
+/// @brief record being filled by the current frame
+FrameRecord& Profiler::current() {
+	return _records[(_frame + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+}
+
+/// @brief copy the results of a set of queries to the record of their frame, without waiting: a result not available yet is
+/// dropped (the section keeps -1), and so is one whose frame left the history
+/// @param set index of the set of queries
+/// @param frame index of the frame that issued them
+void Profiler::readQueries(size_t set, size_t frame) {
+	FrameRecord& record = _records[frame % PROFILE_HISTORY];
+	for (size_t s = 0; s < PROFILE_SECTION_COUNT; s++) {
+		if (!_issued[set][s])
+			continue;
+		_issued[set][s] = false;
+		GLuint available = 0;
+		glGetQueryObjectuiv(_queries[set][s], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available || record.index != frame)
+			continue;
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(_queries[set][s], GL_QUERY_RESULT, &ns);
+		record.gpuMs[s] = static_cast<float>(ns / 1e6);
+	}
+}
+
+/// @brief start the GL_TIME_ELAPSED query of a section in the set of the current frame, the queries created on first use
+void Profiler::beginQuery(ProfileSection section) {
+	size_t set = (_frame + QUERY_SETS - 1) % QUERY_SETS;
+	if (!_queries[set][0])
+		glGenQueries(PROFILE_SECTION_COUNT, _queries[set]);
+	glBeginQuery(GL_TIME_ELAPSED, _queries[set][section]);
+}
+
+/// @brief end the GL_TIME_ELAPSED query of a section, its result read two frames later
+void Profiler::endQuery(ProfileSection section) {
+	glEndQuery(GL_TIME_ELAPSED);
+	_issued[(_frame + QUERY_SETS - 1) % QUERY_SETS][section] = true;
+}
+
+//getters
+/// @brief number of finished frames kept, for record
+size_t Profiler::frames() const {return _frame ? std::min(_frame - 1, PROFILE_HISTORY - 1) : 0;}
+/// @brief a finished frame, 0 the last one, up to frames() - 1
+const FrameRecord& Profiler::record(size_t age) const {return _records[(_frame - 2 - age) % PROFILE_HISTORY];}
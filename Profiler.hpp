@@ -0,0 +1,82 @@
+#pragma once
+
+#include "GLState.hpp"
+#include <chrono>
+#include <string>
+
+// parts of a frame of renderLoop, timed by Profiler::Scope
+enum ProfileSection {
+	PROFILE_INPUT,		// pollModelLoad and processInput
+	PROFILE_MATRICES,	// glClear and defineMatrices
+	PROFILE_DRAW,		// Model::Draw
+	PROFILE_MESHES,		// the Meshes drawn by the RenderQueue, summed (inside PROFILE_DRAW)
+	PROFILE_UI,			// createUIImgui
+	PROFILE_SWAP,		// glfwSwapBuffers and glfwPollEvents (glFinish with --bench)
+	PROFILE_SECTION_COUNT
+};
+
+// frames kept by the Profiler, for the histograms and the CSV
+static const size_t	PROFILE_HISTORY = 240;
+
+// one frame of renderLoop, in milliseconds
+struct FrameRecord {
+	size_t		index = 0;							// frames before it since the start
+	float		frameMs = 0.f;						// from its beginFrame to the next one
+	float		cpuMs[PROFILE_SECTION_COUNT] = {};
+	float		gpuMs[PROFILE_SECTION_COUNT] = {};	// -1 if the section has no query or its result was not ready two frames later
+	size_t		meshes = 0;							// PROFILE_MESHES scopes
+	GLCallStats	calls;								// GL calls of the frame (GLState)
+};
+
+/**
+ * @brief per-frame timings of renderLoop: CPU time of each section with Scope, GPU time of some of them with GL_TIME_ELAPSED
+ * queries, and the GL counters of GLState, kept for the last PROFILE_HISTORY frames.
+ *
+ * The queries of a frame are read at the start of the one two frames later, and only if their result is already there: two
+ * sets of queries in flight, the CPU never waits for the GPU. GL_TIME_ELAPSED queries do not nest, so only the sections
+ * that never overlap (PROFILE_MATRICES, PROFILE_DRAW, PROFILE_UI) have one. GL thread only.
+ */
+class Profiler {
+	public:
+		using clock = std::chrono::steady_clock;
+
+		/// @brief times a section from its construction to its destruction, added to the section in the current frame
+		class Scope {
+			public:
+				Scope(ProfileSection section, bool gpu = false);
+				~Scope();
+				Scope(const Scope& oth) = delete;
+				Scope& operator=(const Scope& oth) = delete;
+
+			private:
+				ProfileSection		_section;
+				bool				_gpu;
+				clock::time_point	_start;
+		};
+
+		static Profiler&	instance();
+		static const char*	name(ProfileSection section);
+
+		void	beginFrame();
+		void	release();
+		bool	dumpCsv(const std::string& path) const;
+
+		//getters
+		size_t				frames() const;
+		const FrameRecord&	record(size_t age) const;
+
+	private:
+		static const size_t	QUERY_SETS = 2;
+
+		FrameRecord			_records[PROFILE_HISTORY];
+		size_t				_frame = 0;		// frames begun, the current one being _records[(_frame - 1) % PROFILE_HISTORY]
+		clock::time_point	_frameStart;
+		GLuint				_queries[QUERY_SETS][PROFILE_SECTION_COUNT] = {};
+		bool				_issued[QUERY_SETS][PROFILE_SECTION_COUNT] = {};
+
+		Profiler() = default;
+		FrameRecord&	current();
+		void			readQueries(size_t set, size_t frame);
+		void			beginQuery(ProfileSection section);
+		void			endQuery(ProfileSection section);
+};
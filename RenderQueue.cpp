@@ -0,0 +1,67 @@
+#include "RenderQueue.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "Mesh.hpp"
+#include "UniformBuffers.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+/// @brief remove every queued Mesh
+void RenderQueue::clear() {
+	_items.clear();
+	_materialRanks.clear();
+}
+
+/// @brief queue a Mesh, drawn by the next flush. The Mesh and Material must stay where they are until then
+/// @param shader program to draw the Mesh with
+/// @param table MaterialTable of the Model of the Mesh, holding material by the flush
+/// @param material Material of the Mesh
+/// @param mesh Mesh uploaded to a MeshArena
+void RenderQueue::push(Shader& shader, const MaterialTable& table, Material& material, Mesh& mesh) {
+	size_t rank = _materialRanks.emplace(&material, _materialRanks.size()).first->second;
+	_items.push_back({&shader, &table, &material, rank, mesh.VAO(), &mesh});
+}
+
+/// @brief draw the queued Meshes sorted by shader, Material and VAO (a Material keeps the order of its Meshes), then empty the queue.
+/// Leaves texture unit 0 active and no VAO bound
+void RenderQueue::flush() {
+	auto key = [](const RenderItem& item) { return std::make_tuple(item.shader->getID(), item.materialRank, item.vao); };
+	std::stable_sort(_items.begin(), _items.end(), [&](const RenderItem& a, const RenderItem& b) { return key(a) < key(b); });
+
+	GLState& gl = GLState::instance();
+	Shader* shader = nullptr;
+	Material* material = nullptr;
+	GLuint vao = 0;
+	Mesh* previous = nullptr;	// last Mesh drawn with the current shader, for its layout uniforms
+	for (auto& item : _items) {
+		Profiler::Scope scope(PROFILE_MESHES);
+		bool newShader = item.shader != shader;
+		if (newShader) {
+			shader = item.shader;
+			Mesh::setDrawState(*shader);
+			previous = nullptr;
+		}
+		if (newShader || item.material != material) {
+			material = item.material;
+			Mesh::bindTextures(*material);
+			item.table->use(*shader, *material);
+		}
+		if (newShader || item.vao != vao) {
+			vao = item.vao;
+			gl.bindVertexArray(vao);
+			shader->set(shader->uniforms.packedVertex, item.mesh->packed());
+		}
+		// float vertices all have the same (identity) layout, packed ones one per Mesh
+		if (!previous || !(previous->posMin() == item.mesh->posMin()) || !(previous->posScale() == item.mesh->posScale()))
+			item.mesh->setLayout(*shader);
+		previous = item.mesh;
+		item.mesh->drawElements();
+	}
+	gl.activeTexture(0);
+	gl.bindVertexArray(0);
+	clear();
+}
+
+/// @brief number of Meshes queued
+size_t RenderQueue::size() const {return _items.size();}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Shader.hpp"
+#include "Includes/struct.hpp"
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class MaterialTable;
+
+// one Mesh to draw, with what it needs bound
+struct RenderItem {
+	Shader*					shader;
+	const MaterialTable*	table;		// of the Model of the Mesh, holding the colours of material
+	Material*				material;
+	size_t					materialRank;	// order of the first push of the Material, a stable sort key unlike its address
+	GLuint					vao;
+	Mesh*					mesh;
+};
+
+/**
+ * @brief the Meshes of a frame, sorted by shader, then Material, then VAO, and drawn setting only what changes from one to
+ * the next: the frame state once per shader, textures and MaterialTable row once per Material, the vertex layout once per VAO.
+ * The remaining binds go through GLState, which skips those already in place. GL thread only.
+ */
+class RenderQueue {
+	public:
+		void	clear();
+		void	push(Shader& shader, const MaterialTable& table, Material& material, Mesh& mesh);
+		void	flush();
+		size_t	size() const;
+
+	private:
+		std::vector<RenderItem>					_items;
+		std::unordered_map<Material*, size_t>	_materialRanks;
+};
@@ -1,16 +1,25 @@
 #include "Shader.hpp"
 #include "CreateShader.hpp"
+#include "GLExtensions.hpp"
+#include "GLState.hpp"
+#include "UniformBuffers.hpp"
+
+#include <algorithm>
 
 
 /// @brief Shader Constructor that load and compile the shader files (fragment and Vertex) and send it to openGL
 /// @param vertexFilePath Vertex shader file path
 /// @param fragmentFilePath Fragment shader file path
+/// @param defines lines inserted after the #version line of both shaders ("#define NAME\n"...), to compile a variant (see ShaderVariants)
 /// @throw throw an exception when one is caught if the conversion from file to string failed
 /// @throw throw an exception when Shader Compilation failed
 /// @throw throw an exception when Shader Program Creation failed
-Shader::Shader(std::string vertexFilePath, std::string fragmentFilePath) {
+///
+/// With setup.shaderCache the linked program is kept on disk (glGetProgramBinary) and the next launches load it instead of
+/// compiling the sources, as long as the sources, defines and driver are the same (see ShaderCache.cpp)
+Shader::Shader(std::string vertexFilePath, std::string fragmentFilePath, const std::string& defines) {
 
-	std::cout << "Shader Constructor called" << std::endl;
+	std::cerr << "Shader Constructor called" << std::endl;
 	std::string vShaderCode, fShaderCode;
 	unsigned int vertex, fragment;
 	
@@ -21,6 +30,21 @@ Shader::Shader(std::string vertexFilePath, std::string fragmentFilePath) {
 		std::cerr << "Error: Shader constructor failed.\n";
 		throw;
 	}
+	insertDefines(vShaderCode, defines);
+	insertDefines(fShaderCode, defines);
+
+	// same sources on the same driver: the program linked by a previous launch
+	std::string cachePath;
+	uint64_t key = 0;
+	if (setup.shaderCache && glExtensions.programBinary) {
+		key = cacheKey(vShaderCode, fShaderCode);
+		cachePath = cacheFilePath(vertexFilePath, fragmentFilePath, defines, key);
+		if (loadBinary(cachePath, key)) {
+			_fromCache = true;
+			loadUniforms();
+			return;
+		}
+	}
 	
 	if (!CompileShader(vertex, vShaderCode.c_str(), GL_VERTEX_SHADER)){
 		throw std::runtime_error("Vertex Shader compilation failed");
@@ -36,12 +60,15 @@ Shader::Shader(std::string vertexFilePath, std::string fragmentFilePath) {
 	}
 	glDeleteShader(vertex);
 	glDeleteShader(fragment);
+	loadUniforms();
+	if (!cachePath.empty())
+		storeBinary(cachePath, key);
 }
 
 /// @brief delete the shader program
 Shader::~Shader() {
 
-	std::cout << "Shader Destroyer called" << std::endl;
+	std::cerr << "Shader Destroyer called" << std::endl;
 
     if (ID != 0)
         glDeleteProgram(ID);
@@ -49,6 +76,20 @@ Shader::~Shader() {
 }
 
 
+/// @brief constructor subfunction that inserts the defines after the #version line, which must stay the first one
+/// @param code shader source
+/// @param defines lines to insert, each ending with a newline
+void Shader::insertDefines(std::string& code, const std::string& defines) {
+	if (defines.empty())
+		return;
+	size_t line = 0;
+	if (code.compare(0, 8, "#version") == 0) {
+		line = code.find('\n');
+		line = line == std::string::npos ? code.size() : line + 1;
+	}
+	code.insert(line, defines);
+}
+
 /// @brief constructor subfunction that compile the shader code and set the shadr ID needed for the the shader program
 /// @param shader reference of an empty variable that will be set for the creation of the shader program
 /// @param shaderCode shader file code stocked into a string that will be compiled
@@ -81,6 +122,8 @@ int Shader::CreateShaderProgram(unsigned int vertex, unsigned int fragment) {
 	
 	// CompileShader(frag, CreateShader().getContent().c_str(), GL_FRAGMENT_SHADER);
 	ID = glCreateProgram();
+	if (setup.shaderCache && glExtensions.programBinary)
+		glExtensions.ProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glAttachShader(ID, vertex);
 	glAttachShader(ID, fragment);
 	// glAttachShader(ID, frag);
@@ -96,53 +139,153 @@ int Shader::CreateShaderProgram(unsigned int vertex, unsigned int fragment) {
 	// glDeleteShader(frag);
 }
 
+/// @brief constructor subfunction that lists the active uniforms of the linked program (glGetActiveUniform) and keeps their location,
+/// then resolves the handles of the model shaders uniforms (those the program does not have stay -1) and binds their uniform blocks
+void Shader::loadUniforms() {
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::string name(std::max(maxLength, 1), '\0');
+	for (GLint i = 0; i < count; i++) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, i, maxLength, &length, &size, &type, name.data());
+		std::string uniformName = name.substr(0, length);
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+			uniformName.resize(uniformName.size() - 3);
+		// the location is not the index of the active uniform
+		_locations[uniformName] = glGetUniformLocation(ID, uniformName.c_str());
+	}
+
+	auto find = [this](const char* name) {
+		auto it = _locations.find(name);
+		return it == _locations.end() ? -1 : it->second;
+	};
+	uniforms.model.location = find("model");
+	uniforms.packedVertex.location = find("packedVertex");
+	uniforms.indirectDraw.location = find("indirectDraw");
+	uniforms.posMin.location = find("posMin");
+	uniforms.posScale.location = find("posScale");
+	uniforms.drawTable.location = find("drawTable");
+	uniforms.customTex.location = find("customTex");
+	uniforms.materialDiffuse.location = find("material.diffuse");
+	uniforms.materialSpecular.location = find("material.specular");
+	uniforms.materialNormalMap.location = find("material.normalMap");
+	uniforms.materialIndex.location = find("materialIndex");
+
+	// GLSL 330 has no binding layout qualifier: the blocks are given their binding point here
+	GLuint frame = glGetUniformBlockIndex(ID, "Frame");
+	if (frame != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, frame, FRAME_BLOCK_BINDING);
+	GLuint materials = glGetUniformBlockIndex(ID, "Materials");
+	if (materials != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, materials, MATERIAL_BLOCK_BINDING);
+}
+
+/// @brief cached location of a uniform. A name the program does not have is reported once, then set silently does nothing
+/// @param name uniform name, as in the shader
+/// @return the location, -1 if there is no such active uniform
+GLint Shader::location(const std::string &name) const {
+	auto it = _locations.find(name);
+	if (it != _locations.end())
+		return it->second;
+	std::cerr << "Warning: uniform '" << name << "' is not an active uniform of the shader program " << ID << std::endl;
+	_locations[name] = -1;
+	return -1;
+}
+
 /// @brief call function to use the shader program
 void Shader::use() 
 { 
-    glUseProgram(ID);
+    GLState::instance().useProgram(ID);
 }
 
 //________________ Set of functions that set variables 'values' to a 'named' variable in the shader program_____________________//
 
+void Shader::set(Uniform<bool> uniform, bool value) const
+{
+	set(Uniform<int>{uniform.location}, (int)value);
+}
+void Shader::set(Uniform<int> uniform, int value) const
+{
+	if (uniform.location < 0)
+		return;
+	glUniform1i(uniform.location, value);
+	GLState::instance().countUniform();
+}
+void Shader::set(Uniform<float> uniform, float value) const
+{
+	if (uniform.location < 0)
+		return;
+	glUniform1f(uniform.location, value);
+	GLState::instance().countUniform();
+}
+void Shader::set(Uniform<vec3> uniform, const vec3 &value) const
+{
+	if (uniform.location < 0)
+		return;
+	glUniform3f(uniform.location, value.data[0], value.data[1], value.data[2]);
+	GLState::instance().countUniform();
+}
+void Shader::set(Uniform<mat4> uniform, const mat4 &value) const
+{
+	if (uniform.location < 0)
+		return;
+	glUniformMatrix4fv(uniform.location, 1, GL_TRUE, value.data);
+	GLState::instance().countUniform();
+}
+
 void Shader::setBool(const std::string &name, bool value) const
 {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+	set(uniform<bool>(name), value);
 }
 void Shader::setInt(const std::string &name, int value) const
 { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+	set(uniform<int>(name), value);
 }
 void Shader::setFloat(const std::string &name, float value) const
 { 
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+	set(uniform<float>(name), value);
 }
 
 void Shader::setMat(const char *name, const float* array) {
-	int uniformLocation = glGetUniformLocation(ID, name);
+	GLint uniformLocation = location(name);
+	if (uniformLocation < 0)
+		return;
 	glUniformMatrix4fv(uniformLocation, 1, GL_TRUE, array);
+	GLState::instance().countUniform();
 }
 void Shader::setVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+	set(uniform<vec3>(name), vec3{x, y, z});
 }
 
 void Shader::setVec3(const std::string &name, const vec3 &value) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), value[0], value[1], value[2]);
+	set(uniform<vec3>(name), value);
 }
 void Shader::setVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+	GLint uniformLocation = location(name);
+	if (uniformLocation < 0)
+		return;
+	glUniform2f(uniformLocation, x, y);
+	GLState::instance().countUniform();
 }
 
 void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+	GLint uniformLocation = location(name);
+	if (uniformLocation < 0)
+		return;
+	glUniform4f(uniformLocation, x, y, z, w);
+	GLState::instance().countUniform();
 }
 
 void Shader::setVec4(const std::string &name, const vec4 &value) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), value[0], value[1], value[2], value[3]);
+	setVec4(name, value.data[0], value.data[1], value.data[2], value.data[3]);
 }
 
 // // attempt to add other shader post hoc to the program
@@ -165,4 +308,8 @@ void Shader::setVec4(const std::string &name, const vec4 &value) const
 
 unsigned int Shader::getID() {
 	return ID;
-}
\ No newline at end of file
+}
+/// @brief true if the program was loaded from the program binary cache instead of compiled
+bool Shader::fromCache() const {
+	return _fromCache;
+}
@@ -8,10 +8,29 @@
 #include <sstream>
 #include <iostream>
 #include <exception>
+#include <unordered_map>
+#include <cstdint>
 #include "vml.hpp"
 
 using namespace vml;
 
+// location of a uniform of type T, resolved once (Shader::uniform) so setting it is a single glUniform call, without string lookup
+template <typename T>
+struct Uniform {
+	GLint	location = -1;	// -1 if the program has no such active uniform, setting it then does nothing
+};
+
+// handles of the uniforms of the model shaders (FinalVertexTexShad / FinalFragTexShad), resolved after link. The texture
+// toggles and view modes are #defines of the variant instead (ShaderVariants)
+struct ShaderUniforms {
+	Uniform<mat4>	model;
+	Uniform<bool>	packedVertex, indirectDraw;
+	Uniform<vec3>	posMin, posScale;
+	Uniform<int>	drawTable, customTex;
+	Uniform<int>	materialDiffuse, materialSpecular, materialNormalMap;
+	Uniform<int>	materialIndex;	// row of the Materials block, the camera and light being in the Frame block (see UniformBuffers)
+};
+
 class Shader
 {
 public:
@@ -20,13 +39,35 @@ public:
     	unsigned int ID;
 		int CompileShader(unsigned int& shader, const char* shaderCode, unsigned int type);
 		int CreateShaderProgram(unsigned int, unsigned int);
+		void loadUniforms();
+		static void insertDefines(std::string& code, const std::string& defines);
+		bool _fromCache = false;
+
+		//in ShaderCache.cpp, program binaries kept on disk
+		static uint64_t cacheKey(const std::string& vertexCode, const std::string& fragmentCode);
+		static std::string cacheFilePath(const std::string& vertexFilePath, const std::string& fragmentFilePath,
+			const std::string& defines, uint64_t key);
+		bool loadBinary(const std::string& cachePath, uint64_t key);
+		void storeBinary(const std::string& cachePath, uint64_t key);
+		GLint location(const std::string &name) const;
+
+		// active uniforms by name (array ones without their "[0]"), then the missing names already warned about (-1)
+		mutable std::unordered_map<std::string, GLint> _locations;
 	public:
 		// constructor reads and builds the shader
 		// Shader(const char* vertexCode, const char* fragmentCode);
-		Shader(std::string vertexFilePath, std::string fragmentFilePath);
+		Shader(std::string vertexFilePath, std::string fragmentFilePath, const std::string& defines = "");
 		~Shader();
+		ShaderUniforms uniforms;	// typed handles, for the calls made for every Mesh
 		// use/activate the shader
 		void use();
+		template <typename T>
+		Uniform<T> uniform(const std::string &name) const {return Uniform<T>{location(name)};}
+		void set(Uniform<bool> uniform, bool value) const;
+		void set(Uniform<int> uniform, int value) const;
+		void set(Uniform<float> uniform, float value) const;
+		void set(Uniform<vec3> uniform, const vec3 &value) const;
+		void set(Uniform<mat4> uniform, const mat4 &value) const;
 		// utility uniform functions
 		void setBool(const std::string &name, bool value) const;  
 		void setInt(const std::string &name, int value) const;   
@@ -40,6 +81,7 @@ public:
 		void setVec4(const std::string &name, const vec4 &value) const;
 		// void addShader(const char *shaderCode, unsigned int type);
 		unsigned int getID();
+		bool fromCache() const;
 };
   
 #endif
\ No newline at end of file
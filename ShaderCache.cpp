@@ -0,0 +1,182 @@
+#include "Shader.hpp"
+#include "GLExtensions.hpp"
+#include "MappedFile.hpp"
+#include "Includes/header.h"
+
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+/*
+ * .scopprog layout (native endianness), one file per program (variant):
+ *
+ *	"SCOPPROG" | u32 version | u32 binary format | u64 key | u64 length | binary[length]
+ *
+ *	key = FNV-1a of the vertex and fragment sources (defines included) and of the GL vendor, renderer and version strings
+ *
+ * named <fragment stem>-<variant>-<key>.scopprog, variant = FNV-1a of the shader paths and defines: a new key of a variant
+ * replaces its previous file instead of adding one next to it
+ */
+static const char		PROGRAM_MAGIC[8] = {'S', 'C', 'O', 'P', 'P', 'R', 'O', 'G'};
+static const uint32_t	PROGRAM_VERSION = 1;
+
+struct ProgramHeader {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	format;
+	uint64_t	key;
+	uint64_t	length;
+};
+
+/// @brief Utilitary function adding a string and its terminating zero to a FNV-1a hash
+static void hashString(uint64_t& hash, const char* str) {
+	do {
+		hash ^= static_cast<unsigned char>(*str);
+		hash *= 1099511628211ull;
+	} while (*str++);
+}
+
+/// @brief true if str is count lowercase hexadecimal digits from pos
+static bool isHex(const std::string& str, size_t pos, size_t count) {
+	if (pos + count > str.size())
+		return false;
+	for (size_t i = pos; i < pos + count; i++)
+		if ((str[i] < '0' || str[i] > '9') && (str[i] < 'a' || str[i] > 'f'))
+			return false;
+	return true;
+}
+
+/// @brief remove the binaries a variant was stored under before its key changed (edited sources, driver update), and those of
+/// the former <fragment stem>-<key>.scopprog naming, which the variants shared. Not fatal, a file left behind is never read.
+/// @param cachePath .scopprog just written, <fragment stem>-<variant>-<key>.scopprog
+static void removeStaleBinaries(const std::string& cachePath) {
+	static const size_t keyLength = 16 + std::strlen(".scopprog");
+	static const size_t variantLength = 8 + 1;
+	std::filesystem::path path(cachePath);
+	std::string name = path.filename().string();
+	if (name.size() < keyLength + variantLength)
+		return;
+	std::string variantPrefix = name.substr(0, name.size() - keyLength);
+	std::string stemPrefix = variantPrefix.substr(0, variantPrefix.size() - variantLength);
+	std::filesystem::path dir = path.parent_path().empty() ? std::filesystem::path(".") : path.parent_path();
+
+	std::error_code ec;
+	for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+		std::string other = it->path().filename().string();
+		if (other == name || !other.ends_with(".scopprog"))
+			continue;
+		bool sameVariant = other.size() == name.size() && other.starts_with(variantPrefix) && isHex(other, variantPrefix.size(), 16);
+		bool formerNaming = other.size() == stemPrefix.size() + keyLength && other.starts_with(stemPrefix) && isHex(other, stemPrefix.size(), 16);
+		if (sameVariant || formerNaming)
+			std::filesystem::remove(it->path(), ec);
+	}
+}
+
+/// @brief key of a program in the cache: its sources and the driver that would compile them, a new driver version invalidating its binaries
+/// @param vertexCode vertex shader source, defines included
+/// @param fragmentCode fragment shader source, defines included
+uint64_t Shader::cacheKey(const std::string& vertexCode, const std::string& fragmentCode) {
+	uint64_t hash = 1469598103934665603ull;
+	hashString(hash, vertexCode.c_str());
+	hashString(hash, fragmentCode.c_str());
+	for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		const char* str = reinterpret_cast<const char*>(glGetString(name));
+		hashString(hash, str ? str : "");
+	}
+	return hash;
+}
+
+/// @brief path of the .scopprog of a program: next to its fragment shader (Frag.glsl -> Frag-<variant>-<key>.scopprog), or in
+/// setup.cacheDir
+/// @param vertexFilePath Vertex shader file path
+/// @param fragmentFilePath Fragment shader file path
+/// @param defines defines of the variant
+/// @param key cacheKey of the program
+std::string Shader::cacheFilePath(const std::string& vertexFilePath, const std::string& fragmentFilePath, const std::string& defines,
+	uint64_t key) {
+	std::filesystem::path frag(fragmentFilePath);
+	std::filesystem::path dir = setup.cacheDir.empty() ? frag.parent_path() : std::filesystem::path(setup.cacheDir);
+	uint64_t variant = 1469598103934665603ull;
+	hashString(variant, vertexFilePath.c_str());
+	hashString(variant, fragmentFilePath.c_str());
+	hashString(variant, defines.c_str());
+	char hex[8 + 1 + 16 + 1];
+	snprintf(hex, sizeof(hex), "%08x-%016llx", static_cast<unsigned int>(variant ^ (variant >> 32)), static_cast<unsigned long long>(key));
+	return (dir / (frag.stem().string() + "-" + hex + ".scopprog")).string();
+}
+
+/// @brief try to create the program from its .scopprog. The driver may still refuse the binary (GL_LINK_STATUS), e.g. after an update
+/// it does not report in its version string
+/// @param cachePath .scopprog location path
+/// @param key cacheKey the file must have been written with
+/// @return false if there is no usable binary (no program is left behind), true if ID is the linked program
+bool Shader::loadBinary(const std::string& cachePath, uint64_t key) {
+	MappedFile file;
+	try {
+		file.open(cachePath);
+	} catch (std::exception&) {
+		return false;
+	}
+	ProgramHeader header;
+	if (file.size() < sizeof(header))
+		return false;
+	memcpy(&header, file.data(), sizeof(header));
+	if (memcmp(header.magic, PROGRAM_MAGIC, sizeof(PROGRAM_MAGIC)) != 0 || header.version != PROGRAM_VERSION
+		|| header.key != key || header.length != file.size() - sizeof(header))
+		return false;
+
+	ID = glCreateProgram();
+	glExtensions.ProgramBinary(ID, header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.length));
+	GLint success = 0;
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(ID);
+		ID = 0;
+		return false;
+	}
+	return true;
+}
+
+/// @brief write the binary of the linked program in a .scopprog. Not fatal: on failure the next launch compiles the sources again.
+///
+/// The file is written next to its final path then renamed, so a crash never leaves a half written binary behind, then the
+/// binaries of the previous keys of the variant are removed (see removeStaleBinaries).
+/// @param cachePath .scopprog location path
+/// @param key cacheKey of the program
+void Shader::storeBinary(const std::string& cachePath, uint64_t key) {
+	GLint length = 0;
+	glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	ProgramHeader header = {};
+	memcpy(header.magic, PROGRAM_MAGIC, sizeof(PROGRAM_MAGIC));
+	header.version = PROGRAM_VERSION;
+	header.key = key;
+	std::vector<char> binary(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glExtensions.GetProgramBinary(ID, length, &written, &format, binary.data());
+	if (written <= 0)
+		return;
+	header.format = format;
+	header.length = static_cast<uint64_t>(written);
+
+	std::error_code ec;
+	std::filesystem::path dir = std::filesystem::path(cachePath).parent_path();
+	if (!dir.empty())
+		std::filesystem::create_directories(dir, ec);
+	std::string tmpPath = cachePath + ".tmp";
+	std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+	if (out.is_open()) {
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(binary.data(), written);
+		out.close();
+		if (out && std::rename(tmpPath.c_str(), cachePath.c_str()) == 0) {
+			removeStaleBinaries(cachePath);
+			return;
+		}
+	}
+	std::remove(tmpPath.c_str());
+	std::cerr << "Error: Could not write program binary cache file: " << cachePath << std::endl;
+}
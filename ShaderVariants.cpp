@@ -0,0 +1,73 @@
+#include "ShaderVariants.hpp"
+#include "IndirectDraws.hpp"
+#include "Includes/header.h"
+
+/// @brief keep the shader files and compile the variant without feature, so a shader that does not build is reported at startup
+/// @param vertexFilePath Vertex shader file path
+/// @param fragmentFilePath Fragment shader file path
+/// @throw an exception if the shaders do not compile or link (see Shader)
+ShaderVariants::ShaderVariants(std::string vertexFilePath, std::string fragmentFilePath)
+	: _vertexPath(vertexFilePath), _fragmentPath(fragmentFilePath) {
+	get(0u);
+}
+
+/// @brief the variant of a set of features, compiled on first use
+/// @param features SHADER_* bits
+/// @throw an exception if the variant does not compile or link
+Shader& ShaderVariants::get(unsigned features) {
+	static const char* names[SHADER_FEATURE_COUNT] = {"SHOW_FACES", "CHANGE_COLOR", "CUSTOM_TEX", "DIFFUSE_MAP", "SPECULAR_MAP", "NORMAL_MAP"};
+
+	features &= (1u << SHADER_FEATURE_COUNT) - 1;
+	std::unique_ptr<Shader>& variant = _variants[features];
+	if (variant)
+		return *variant;
+
+	std::string defines;
+	for (unsigned i = 0; i < SHADER_FEATURE_COUNT; i++)
+		if (features & (1u << i))
+			defines += std::string("#define ") + names[i] + "\n";
+	variant = std::make_unique<Shader>(_vertexPath, _fragmentPath, defines);
+	_compiled++;
+
+	// the texture units never change, drawTable never on unit 0: a samplerBuffer and the sampler2D there would make the draws invalid
+	Shader& shader = *variant;
+	shader.use();
+	shader.set(shader.uniforms.customTex, 0);
+	shader.set(shader.uniforms.materialDiffuse, 1);
+	shader.set(shader.uniforms.materialSpecular, 2);
+	shader.set(shader.uniforms.materialNormalMap, 3);
+	shader.set(shader.uniforms.drawTable, DRAW_TABLE_UNIT);
+	return shader;
+}
+
+/// @brief the variant drawing a Material in the current view mode
+/// @throw an exception if the variant does not compile or link
+Shader& ShaderVariants::get(Material& material) {
+	return get(features(material));
+}
+
+/**
+ * @brief features of the variant drawing a Material in the current view mode (setup). The view modes replace the whole
+ * lighting, their variants ignore the Material: one program each whatever the textures.
+ * @param material Material of the Mesh(es) to draw
+ * @return SHADER_* bits
+ */
+unsigned ShaderVariants::features(Material& material) {
+	if (setup.showFaces)
+		return SHADER_SHOW_FACES;
+	if (setup.showColors)
+		return SHADER_CHANGE_COLOR;
+	unsigned features = 0;
+	if (setup.applyCustomTexture && setup.custom.id())
+		features |= SHADER_CUSTOM_TEX;
+	else if (material.diffuseTex.id() != 0)
+		features |= SHADER_DIFFUSE_MAP;
+	if (material.specularTex.id() != 0)
+		features |= SHADER_SPECULAR_MAP;
+	if (material.normalTex.id() != 0)
+		features |= SHADER_NORMAL_MAP;
+	return features;
+}
+
+/// @brief number of variants compiled so far
+size_t ShaderVariants::compiled() const {return _compiled;}
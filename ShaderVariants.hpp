@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Shader.hpp"
+#include "Includes/struct.hpp"
+#include <memory>
+#include <string>
+
+// features of a model shader variant, each one a #define of FinalFragTexShad
+static const unsigned	SHADER_SHOW_FACES = 1u << 0;
+static const unsigned	SHADER_CHANGE_COLOR = 1u << 1;
+static const unsigned	SHADER_CUSTOM_TEX = 1u << 2;
+static const unsigned	SHADER_DIFFUSE_MAP = 1u << 3;
+static const unsigned	SHADER_SPECULAR_MAP = 1u << 4;
+static const unsigned	SHADER_NORMAL_MAP = 1u << 5;
+static const unsigned	SHADER_FEATURE_COUNT = 6;
+
+/**
+ * @brief the model shader compiled once per combination of features in use, each with the #defines of its features so the
+ * fragment shader has no branch on a toggle: which textures the Material has and the view mode (faces, UV colours, custom
+ * texture). A variant is compiled the first time a Mesh needs it and kept, its sampler units set once. GL thread only.
+ */
+class ShaderVariants {
+	public:
+		ShaderVariants(std::string vertexFilePath, std::string fragmentFilePath);
+		ShaderVariants(const ShaderVariants& oth) = delete;
+		ShaderVariants& operator=(const ShaderVariants& oth) = delete;
+
+		Shader&			get(unsigned features);
+		Shader&			get(Material& material);
+		static unsigned	features(Material& material);
+
+		//getters
+		size_t	compiled() const;
+
+	private:
+		std::string				_vertexPath;
+		std::string				_fragmentPath;
+		std::unique_ptr<Shader>	_variants[1u << SHADER_FEATURE_COUNT];	// by features, null until compiled
+		size_t					_compiled = 0;
+};
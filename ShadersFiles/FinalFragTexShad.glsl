@@ -2,20 +2,20 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
-flat in int TriID;
+flat in int MaterialIndex;
 //in mat3 TBN; // Tangent-Bitangent-Normal matrix for normal mapping
 
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform vec3 viewPos;
+// written once per frame (FrameUniforms), same block in the vertex shader
+layout (std140, row_major) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
 
-// Map usage toggles
-uniform bool useDiffuseMap;
-uniform bool useSpecularMap;
-uniform bool useNormalMap;
-uniform bool useCustomTex;
-uniform bool showFaces;
-uniform bool changeColor;
+// Variant (ShaderVariants), #defined after #version for each combination in use:
+// SHOW_FACES, CHANGE_COLOR (view modes), CUSTOM_TEX, DIFFUSE_MAP, SPECULAR_MAP, NORMAL_MAP (textures of the Material)
 
 uniform sampler2D customTex;
 
@@ -23,14 +23,22 @@ struct Material {
     sampler2D diffuse;
     sampler2D specular;
     sampler2D normalMap;
+};
+
+uniform Material material;
+
+// colours of every Material of the Model (MaterialTable), the row of the draw is MaterialIndex
+struct MaterialColors {
     vec3 ambient;
-    vec3 diffuseColor;
-    vec3 specularColor;
     float shininess;
+    vec3 diffuse;
     float opacity;
+    vec3 specular;
 };
 
-uniform Material material;
+layout (std140) uniform Materials {
+    MaterialColors materials[256];
+};
 
 out vec4 FragColor;
 
@@ -44,41 +52,46 @@ vec3 randomColor(int id) {
 
 void main()
 {
-	if (showFaces){
-		FragColor = vec4(randomColor(TriID), 1);
-		return;
-	}
-	if (changeColor){
-		FragColor = vec4(TexCoords,0.5,1);
-		return;
-	}
+#if defined(SHOW_FACES)
+	FragColor = vec4(randomColor(gl_PrimitiveID), 1);
+#elif defined(CHANGE_COLOR)
+	FragColor = vec4(TexCoords,0.5,1);
+#else
+	MaterialColors colors = materials[MaterialIndex];
+	vec3 ambientColor = colors.ambient;
+	vec3 diffuseColor = colors.diffuse;
+	vec3 specularBase = colors.specular;
+	float shininess = colors.shininess;
+	float opacity = colors.opacity;
+
     // Base color (diffuse)
-	vec3 albedo;
-	if (useCustomTex)
-		albedo = texture(customTex, TexCoords).rgb;
-	else if (useDiffuseMap)
-		albedo = texture(material.diffuse, TexCoords).rgb;
-	else
-		albedo = material.diffuseColor;
+#if defined(CUSTOM_TEX)
+	vec3 albedo = texture(customTex, TexCoords).rgb;
+#elif defined(DIFFUSE_MAP)
+	vec3 albedo = texture(material.diffuse, TexCoords).rgb;
+#else
+	vec3 albedo = diffuseColor;
+#endif
 
     // Specular color
-    vec3 specularColor = material.specularColor;
-    if (useSpecularMap)
-        specularColor *= texture(material.specular, TexCoords).rgb;
+    vec3 specularColor = specularBase;
+#ifdef SPECULAR_MAP
+    specularColor *= texture(material.specular, TexCoords).rgb;
+#endif
 
     // Normal map (if present)
     vec3 normal = normalize(Normal);
-    if (useNormalMap) {
-        vec3 tangentNormal = texture(material.normalMap, TexCoords).rgb * 2.0 - 1.0;
-        normal = normalize(tangentNormal);
-    }
+#ifdef NORMAL_MAP
+    vec3 tangentNormal = texture(material.normalMap, TexCoords).rgb * 2.0 - 1.0;
+    normal = normalize(tangentNormal);
+#endif
 
     // Lighting vectors
-    vec3 lightDir = normalize(lightPos - FragPos);
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
 
     // Ambient
-    vec3 ambient = material.ambient * albedo;
+    vec3 ambient = ambientColor * albedo;
 
     // Diffuse
     float diff = max(dot(normal, lightDir), 0.0);
@@ -86,12 +99,13 @@ void main()
 
     // Specular (Blinn–Phong)
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
     vec3 specular = specularColor * spec;
 
     // Combine
-    vec3 color = (ambient + diffuse + specular) * lightColor;
+    vec3 color = (ambient + diffuse + specular) * lightColor.rgb;
 
-    FragColor = vec4(color, material.opacity);
+    FragColor = vec4(color, opacity);
+#endif
 	// FragColor = texture(material.diffuse, TexCoords);
 }
@@ -1,35 +1,74 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPos;		// unorm16 in [0, 1] when packedVertex
+layout (location = 1) in vec3 aNormal;	// unorm16 octahedral encoding in .xy when packedVertex
 layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in int aTriID;
 // layout (location = 3) in vec3 aTangent;
 // layout (location = 4) in vec3 aBitangent;
+layout (location = 5) in uint aDrawID;	// row of the draw in drawTable when indirectDraw
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
-flat out int TriID;
+flat out int MaterialIndex;
 // out mat3 TBN;
 
+// written once per frame (FrameUniforms), same block in the fragment shader
+layout (std140, row_major) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// row of the Material of the draw in the Materials block (MaterialTable)
+uniform int materialIndex;
+
+// vertex layout (Mesh::upload): float or PackedVertex
+uniform bool packedVertex;
+uniform vec3 posMin;
+uniform vec3 posScale;
+
+// all the Meshes at once (IndirectDraws): the values of the uniforms of each draw are in drawTable instead,
+// see IndirectDraws::build for the layout
+uniform bool indirectDraw;
+uniform samplerBuffer drawTable;
+
+vec3 octDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
 
 void main()
 {
     // World position of the vertex
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec3 origin = posMin;
+    vec3 scale = posScale;
+    MaterialIndex = materialIndex;
+    if (indirectDraw) {
+        int row = int(aDrawID) * 2;
+        vec4 originMaterial = texelFetch(drawTable, row);
+        origin = originMaterial.xyz;
+        MaterialIndex = int(originMaterial.w);
+        scale = texelFetch(drawTable, row + 1).xyz;
+    }
+    vec3 position = origin + aPos * scale;
+    vec4 worldPos = model * vec4(position, 1.0);
     FragPos = worldPos.xyz;
 
     // Normal in world space
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec3 normal = packedVertex ? octDecode(aNormal.xy) : aNormal;
+    Normal = mat3(transpose(inverse(model))) * normal;
 
     // Texture coordinates
     TexCoords = aTexCoord;
 
-	TriID = aTriID;
-
     // Compute TBN matrix (only used if you have tangents & bitangents)
     // vec3 T = normalize(mat3(model) * aTangent);
     // vec3 B = normalize(mat3(model) * aBitangent);
@@ -1,7 +1,13 @@
 #include "Texture.hpp"
+#include "TextureCache.hpp"
+#include "TextureUpload.hpp"
+#include "TextureContainer.hpp"
+#include "Includes/header.h"
+
+#include <chrono>
 
 // Default constructor
-Texture::Texture() : _ID(0), _width(0), _height(0), _nrChannels(0) {}
+Texture::Texture() {}
 
 // Copy constructor
 Texture::Texture(const Texture &other) {
@@ -9,25 +15,21 @@ Texture::Texture(const Texture &other) {
   return;
 }
 
-// Copy assignment overload
+// Copy assignment overload, both Textures share the same GL texture
 Texture &Texture::operator=(const Texture &rhs) {
-	_width = rhs._width;
-	_height = rhs._height;
-	_ID = rhs._ID;
-	_nrChannels = rhs._nrChannels;
+	_shared = rhs._shared;
 	return *this;
 }
 
-// Default destructor
+// Default destructor, the GL texture is deleted with its last Texture
 Texture::~Texture() {
 }
 
+/// @brief release this Texture reference, the GL texture is deleted if no other Texture uses it
 void Texture::deleteTex() {
-	if (_ID)
-		glDeleteTextures(1, &_ID);
+	_shared.reset();
 }
 
-
 /**
 *	@brief Simple function to load Texture in already existing class with stb_image library with a filePath and a TextureConfig struct for the configuration (optional as a default value is set)
 *
@@ -37,44 +39,112 @@ void Texture::deleteTex() {
 	@exception throw an exception in case the Image could not be loaded properly.
 */
 void Texture::loadTexture(std::string filePath, TextureConfig config) {
-    stbi_set_flip_vertically_on_load(config.flipVert);
-
-    int reqChannels = 4;
-    unsigned char* data = stbi_load(filePath.c_str(), &_width, &_height, &_nrChannels, reqChannels);
-
-    if (!data) {
-        std::cerr << "Failed to load texture" << std::endl;
-        throw std::runtime_error("Failed to load Texture: " + filePath);
-    }
-
-	_path = filePath;
-    glGenTextures(1, &_ID);
-    glBindTexture(GL_TEXTURE_2D, _ID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, config.params[0]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, config.params[1]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, config.params[2]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, config.params[3]);
-
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RGBA,
-        _width,
-        _height,
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        data
-    );
-
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
+	if (findCached(filePath, config))
+		return;
+	TextureImage image = decode(filePath, config);
+	upload(image);
+}
+
+/**
+*	@brief share the texture of an image already loaded with the same configuration, if any (see TextureCache)
+*
+*	@param filePath a string/char * with the relative or absolute path for the Texture
+*	@param config configuration of the texture, see loadTexture
+*	@return true if the Texture now uses the cached one, false if the image still has to be loaded
+*/
+bool Texture::findCached(std::string filePath, TextureConfig config) {
+	std::shared_ptr<SharedTexture> tex = TextureCache::instance().find(filePath, config);
+	if (!tex)
+		return false;
+	_shared = tex;
+	return true;
+}
+
+/**
+*	@brief CPU half of loadTexture: map the image .scoptex if it is up to date (readTextureContainer), else decode the image file (decodeImage).
+*	No GL call, can run on any thread
+*
+*	@param filePath a string/char * with the relative or absolute path for the Texture
+*	@param config see loadTexture, flipVert and the minifying filter are used here
+*	@return the RGBA pixels
+	@exception throw an exception in case the Image could not be loaded properly.
+*/
+TextureImage Texture::decode(std::string filePath, TextureConfig config) {
+	auto start = std::chrono::steady_clock::now();
+	TextureImage image;
+	if (setup.textureContainers && readTextureContainer(filePath, config, image)) {
+		image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return image;
+	}
+	return decodeImage(filePath, config);
+}
+
+/**
+*	@brief read and decode the image file with stb_image and, if setup.cpuMipmaps is set and the minifying filter
+*	uses mipmaps, build the mip chain (buildMipChain). No GL call, can run on any thread (the flip setting is per thread)
+*
+*	@param filePath a string/char * with the relative or absolute path for the Texture
+*	@param config see loadTexture
+*	@return the decoded RGBA pixels
+	@exception throw an exception in case the Image could not be loaded properly.
+*/
+TextureImage Texture::decodeImage(std::string filePath, TextureConfig config) {
+	auto start = std::chrono::steady_clock::now();
+	TextureImage image;
+	stbi_set_flip_vertically_on_load_thread(config.flipVert);
+
+	int reqChannels = 4;
+	image.data.reset(stbi_load(filePath.c_str(), &image.width, &image.height, &image.nrChannels, reqChannels));
+
+	if (!image.data) {
+		std::cerr << "Failed to load texture" << std::endl;
+		throw std::runtime_error("Failed to load Texture: " + filePath);
+	}
+	image.path = filePath;
+	image.config = config;
+	auto decoded = std::chrono::steady_clock::now();
+	image.decodeMs = std::chrono::duration<double, std::milli>(decoded - start).count();
+
+	bool mipmapped = config.params[2] != GL_NEAREST && config.params[2] != GL_LINEAR;
+	if (setup.cpuMipmaps && mipmapped) {
+		buildMipChain(image);
+		image.mipMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decoded).count();
+	}
+	return image;
+}
+
+/**
+*	@brief GL half of loadTexture: create the texture from decoded pixels, set its parameters, upload every level (TextureUploader) and register it in the TextureCache. Must run on the GL thread
+*
+*	@param image pixels returned by decode, freed once uploaded
+*/
+void Texture::upload(TextureImage& image) {
+	_shared = std::make_shared<SharedTexture>();
+	_shared->path = image.path;
+	_shared->width = image.width;
+	_shared->height = image.height;
+	_shared->nrChannels = image.nrChannels;
+
+	glGenTextures(1, &_shared->id);
+	glBindTexture(GL_TEXTURE_2D, _shared->id);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, image.config.params[0]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, image.config.params[1]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.config.params[2]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, image.config.params[3]);
+
+	TextureUploader::instance().upload(image);
+	image.data.reset();
+	image.mips.clear();
+	image.mips.shrink_to_fit();
+	image.containerPixels = nullptr;
+	image.container.reset();
+	TextureCache::instance().insert(image.path, image.config, _shared);
 }
 
 // unsigned char* Texture::content() {return _data;}
-int Texture::width() {return _width;}
-int Texture::height() {return _height;}
-int Texture::nrChannels() {return _nrChannels;}
-int Texture::id() {return _ID;}
-std::string Texture::path () {return _path;}
+int Texture::width() {return _shared ? _shared->width : 0;}
+int Texture::height() {return _shared ? _shared->height : 0;}
+int Texture::nrChannels() {return _shared ? _shared->nrChannels : 0;}
+int Texture::id() {return _shared ? _shared->id : 0;}
+std::string Texture::path () {return _shared ? _shared->path : "";}
@@ -7,6 +7,9 @@
 #include <GL/glext.h>
 #include "Includes/stb_image.h"
 #include <array>
+#include <memory>
+#include <string>
+#include <vector>
 
 // Class declaration
 struct TextureConfig {
@@ -14,6 +17,44 @@ struct TextureConfig {
     std::array<unsigned int, 4> params = {GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR};
 };
 
+class MappedFile;
+
+// decoded pixels of an image file (always RGBA), not on the GPU yet
+struct TextureImage {
+	std::string										path;
+	int												width = 0;
+	int												height = 0;
+	int												nrChannels = 0;
+	std::unique_ptr<unsigned char, void(*)(void*)>	data{nullptr, stbi_image_free};
+	TextureConfig									config;
+	std::vector<unsigned char>						mips;		// levels 1..n one after the other (see buildMipChain), empty for GPU mipmaps
+	std::shared_ptr<MappedFile>						container;	// .scoptex the levels are read from in place, data and mips are then empty
+	const unsigned char*							containerPixels = nullptr;
+	int												containerLevels = 0;
+	double											decodeMs = 0;
+	double											mipMs = 0;
+
+	// in TextureUpload.cpp
+	int						levelCount() const;
+	const unsigned char*	level(int l) const;
+};
+
+// where the time of one texture went, for the load report
+struct TextureTiming {
+	std::string	path;
+	int			width;
+	int			height;
+	double		decodeMs;	// stb_image, on a worker
+	double		mipMs;		// CPU mip chain, on a worker
+	double		uploadMs;	// GL thread time spent in Texture::upload
+};
+
+struct SharedTexture;
+
+/**
+ * @brief handle on a GL texture shared through the TextureCache: copies reference the same texture,
+ * which is deleted when the last handle is destroyed or released (deleteTex).
+ */
 class Texture {
 	public:
 		Texture();
@@ -22,6 +63,10 @@ class Texture {
 		Texture &operator=(const Texture &rhs);
 		~Texture();
 		void loadTexture(std::string filePath, TextureConfig config = TextureConfig{});
+		bool findCached(std::string filePath, TextureConfig config = TextureConfig{});
+		static TextureImage decode(std::string filePath, TextureConfig config = TextureConfig{});
+		static TextureImage decodeImage(std::string filePath, TextureConfig config = TextureConfig{});
+		void upload(TextureImage& image);
 		void deleteTex();
 		int width();
 		int height();
@@ -30,11 +75,7 @@ class Texture {
 		std::string path();
 
 	private:
-		unsigned int	_ID;
-		std::string		_path;
-		int				_width;		
-		int				_height;	
-		int				_nrChannels;
+		std::shared_ptr<SharedTexture>	_shared;
 };
 
 #endif // TEXTURE_HPP_
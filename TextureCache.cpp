@@ -0,0 +1,70 @@
+#include "TextureCache.hpp"
+
+#include <filesystem>
+
+/// @brief delete the GL texture, called when the last Texture using it is destroyed or released
+SharedTexture::~SharedTexture() {
+	if (id)
+		glDeleteTextures(1, &id);
+}
+
+/// @brief the registry of the program
+TextureCache& TextureCache::instance() {
+	static TextureCache cache;
+	return cache;
+}
+
+/// @brief Utilitary function returning the path an image is registered under: canonical (symlinks, '..' and './' resolved) when possible
+/// @param path image file path as written in the .mtl or given in parameter
+/// @return the resolved path
+std::string TextureCache::resolvePath(const std::string& path) {
+	std::error_code ec;
+	std::filesystem::path resolved = std::filesystem::weakly_canonical(path, ec);
+	if (ec)
+		return std::filesystem::path(path).lexically_normal().string();
+	return resolved.string();
+}
+
+/// @brief registry key: resolved path and every TextureConfig field, as the same image can be used with different samplers
+std::string TextureCache::key(const std::string& path, const TextureConfig& config) {
+	std::string k = resolvePath(path) + "|" + (config.flipVert ? "1" : "0");
+	for (unsigned int param : config.params)
+		k += "|" + std::to_string(param);
+	return k;
+}
+
+/// @brief look a loaded texture up
+/// @param path image file path
+/// @param config configuration the texture was loaded with
+/// @return the shared texture, null if that image is not loaded with that configuration
+std::shared_ptr<SharedTexture> TextureCache::find(const std::string& path, const TextureConfig& config) {
+	auto it = _textures.find(key(path, config));
+	if (it == _textures.end())
+		return nullptr;
+	std::shared_ptr<SharedTexture> tex = it->second.lock();
+	if (!tex)
+		_textures.erase(it);
+	return tex;
+}
+
+/// @brief register a texture just uploaded so the next loads of the same image and configuration share it
+/// @param path image file path
+/// @param config configuration the texture was loaded with
+/// @param tex the uploaded texture
+void TextureCache::insert(const std::string& path, const TextureConfig& config, const std::shared_ptr<SharedTexture>& tex) {
+	for (auto it = _textures.begin(); it != _textures.end();) {
+		if (it->second.expired())
+			it = _textures.erase(it);
+		else
+			++it;
+	}
+	_textures[key(path, config)] = tex;
+}
+
+/// @brief number of textures alive
+size_t TextureCache::size() {
+	size_t n = 0;
+	for (auto& it : _textures)
+		n += !it.second.expired();
+	return n;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Texture.hpp"
+#include <unordered_map>
+#include <memory>
+#include <string>
+
+/**
+ * @brief GL texture shared by every Texture loaded from the same image file with the same TextureConfig.
+ *
+ * Owned through std::shared_ptr by the Textures using it, the GL texture is deleted with the last of them.
+ */
+struct SharedTexture {
+	unsigned int	id = 0;
+	std::string		path;
+	int				width = 0;
+	int				height = 0;
+	int				nrChannels = 0;
+
+	SharedTexture() = default;
+	SharedTexture(const SharedTexture& oth) = delete;
+	SharedTexture& operator=(const SharedTexture& oth) = delete;
+	~SharedTexture();
+};
+
+/**
+ * @brief process-wide registry of the loaded textures, keyed by resolved image path and TextureConfig.
+ *
+ * It only keeps weak references: a texture lives as long as a Texture uses it. GL thread only, like the textures themselves.
+ */
+class TextureCache {
+	public:
+		static TextureCache& instance();
+		static std::string resolvePath(const std::string& path);
+
+		std::shared_ptr<SharedTexture> find(const std::string& path, const TextureConfig& config);
+		void insert(const std::string& path, const TextureConfig& config, const std::shared_ptr<SharedTexture>& tex);
+		size_t size();
+
+	private:
+		TextureCache() = default;
+		std::unordered_map<std::string, std::weak_ptr<SharedTexture>> _textures;
+
+		static std::string key(const std::string& path, const TextureConfig& config);
+};
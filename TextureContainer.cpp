@@ -0,0 +1,101 @@
+#include "TextureContainer.hpp"
+#include "TextureUpload.hpp"
+#include "MappedFile.hpp"
+#include "Includes/header.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static const char	TEXCONTAINER_MAGIC[8] = "SCOPTEX";
+
+/// @brief .scoptex path of an image
+std::string textureContainerPath(const std::string& imagePath) {
+	return imagePath + ".scoptex";
+}
+
+/**
+*	@brief map the .scoptex of an image if there is one matching the image and the configuration. The levels are then read in place
+*	from the mapping (image.container) by the uploader, nothing is decoded nor copied
+*
+*	@param imagePath path of the source image
+*	@param config configuration the texture is loaded with, only the flip has to match
+*	@param image filled on success
+*	@return false if there is no container, or if it is stale, for another flip or invalid: the image has to be decoded
+*/
+bool readTextureContainer(const std::string& imagePath, const TextureConfig& config, TextureImage& image) {
+	std::string path = textureContainerPath(imagePath);
+	int64_t size, mtime, containerSize, containerMtime;
+	if (!fileStamp(path, containerSize, containerMtime) || !fileStamp(imagePath, size, mtime))
+		return false;
+
+	std::shared_ptr<MappedFile> file;
+	try {
+		file = std::make_shared<MappedFile>(path);
+	} catch (std::exception&) {
+		return false;
+	}
+	TextureContainerHeader header;
+	if (file->size() < sizeof(header))
+		return false;
+	memcpy(&header, file->data(), sizeof(header));
+
+	if (memcmp(header.magic, TEXCONTAINER_MAGIC, sizeof(header.magic)) != 0 || header.version != TEXCONTAINER_VERSION
+		|| header.sourceSize != size || header.sourceMtime != mtime
+		|| ((header.flags & TEXCONTAINER_FLIPPED) != 0) != config.flipVert
+		|| header.width <= 0 || header.height <= 0
+		|| header.levels != static_cast<uint32_t>(mipLevelCount(header.width, header.height))
+		|| file->size() != sizeof(header) + mipLevelOffset(header.width, header.height, header.levels))
+		return false;
+
+	image.path = imagePath;
+	image.config = config;
+	image.width = header.width;
+	image.height = header.height;
+	image.nrChannels = header.nrChannels;
+	image.containerPixels = reinterpret_cast<const unsigned char*>(file->data()) + sizeof(header);
+	image.containerLevels = header.levels;
+	image.container = std::move(file);
+	return true;
+}
+
+/**
+*	@brief decode an image, build its mip chain and write them in its .scoptex. The file is written next to its final path
+*	then renamed, so a crash never leaves a half written container behind
+*
+*	@param imagePath path of the source image
+*	@param config the flip the container is written for
+*	@return the container path
+*	@exception throw an exception if the image could not be decoded or the container written
+*/
+std::string writeTextureContainer(const std::string& imagePath, const TextureConfig& config) {
+	std::string path = textureContainerPath(imagePath);
+	TextureImage image = Texture::decodeImage(imagePath, config);
+	if (image.mips.empty())
+		buildMipChain(image);
+
+	TextureContainerHeader header = {};
+	memcpy(header.magic, TEXCONTAINER_MAGIC, sizeof(header.magic));
+	header.version = TEXCONTAINER_VERSION;
+	header.flags = config.flipVert ? TEXCONTAINER_FLIPPED : 0;
+	header.width = image.width;
+	header.height = image.height;
+	header.nrChannels = image.nrChannels;
+	header.levels = image.levelCount();
+	if (!fileStamp(imagePath, header.sourceSize, header.sourceMtime))
+		throw std::runtime_error("Error: Could not stat texture: " + imagePath);
+
+	std::string tmpPath = path + ".tmp";
+	std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		throw std::runtime_error("Error: Could not write texture container: " + path);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(image.data.get()), mipLevelOffset(image.width, image.height, 1));
+	out.write(reinterpret_cast<const char*>(image.mips.data()), image.mips.size());
+	out.close();
+	if (!out || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("Error: Could not write texture container: " + path);
+	}
+	return path;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Texture.hpp"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief .scoptex texture container: the RGBA8 pixels of an image and its whole mip chain, ready to upload.
+ *
+ * Written next to the image (image path + ".scoptex") by the --convert-textures mode. Layout: a TextureContainerHeader then
+ * every level one after the other, level 0 first (see mipLevelOffset). The header keeps the size and modification time of the
+ * source image, a container older than its image is ignored and the image decoded as usual.
+ */
+struct TextureContainerHeader {
+	char		magic[8];		// "SCOPTEX"
+	uint32_t	version;
+	uint32_t	flags;			// TEXCONTAINER_FLIPPED
+	int32_t		width;
+	int32_t		height;
+	int32_t		nrChannels;		// of the source image, the pixels are always RGBA
+	uint32_t	levels;
+	int64_t		sourceSize;
+	int64_t		sourceMtime;
+};
+
+static const uint32_t	TEXCONTAINER_VERSION = 1;
+static const uint32_t	TEXCONTAINER_FLIPPED = 1;
+
+std::string	textureContainerPath(const std::string& imagePath);
+bool		readTextureContainer(const std::string& imagePath, const TextureConfig& config, TextureImage& image);
+std::string	writeTextureContainer(const std::string& imagePath, const TextureConfig& config = TextureConfig{});
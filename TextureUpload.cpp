@@ -0,0 +1,205 @@
+#include "TextureUpload.hpp"
+#include "Includes/header.h"
+
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+//________________ CPU mip chain _____________________//
+
+/// @brief number of levels of a full mip chain, down to 1x1
+int mipLevelCount(int width, int height) {
+	int levels = 1;
+	while (width > 1 || height > 1) {
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		levels++;
+	}
+	return levels;
+}
+
+/// @brief offset in bytes of a level when all the RGBA levels of the chain are stored one after the other, level 0 first
+size_t mipLevelOffset(int width, int height, int level) {
+	size_t offset = 0;
+	for (int l = 0; l < level; l++) {
+		offset += static_cast<size_t>(width) * height * 4;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return offset;
+}
+
+/// @brief Utilitary function averaging a 2x2 block of RGBA pixels, rounded to nearest
+static inline void boxPixel(const unsigned char* a, const unsigned char* b, const unsigned char* c, const unsigned char* d, unsigned char* out) {
+	for (int i = 0; i < 4; i++)
+		out[i] = static_cast<unsigned char>((a[i] + b[i] + c[i] + d[i] + 2) >> 2);
+}
+
+/**
+ * @brief halve an RGBA8 image with a 2x2 box filter. Odd sizes clamp the last row/column (the 2x2 block then reads it twice).
+ *
+ * The SSE2 path does two destination pixels per iteration with 16 bits sums and gives exactly the scalar result.
+ * @param src source pixels, width x height
+ * @param width source width
+ * @param height source height
+ * @param dst destination pixels, max(1, width / 2) x max(1, height / 2)
+ */
+void downsampleBox(const unsigned char* src, int width, int height, unsigned char* dst) {
+	int dw = std::max(1, width / 2);
+	int dh = std::max(1, height / 2);
+	size_t stride = static_cast<size_t>(width) * 4;
+
+	for (int y = 0; y < dh; y++) {
+		const unsigned char* row0 = src + static_cast<size_t>(std::min(2 * y, height - 1)) * stride;
+		const unsigned char* row1 = src + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * stride;
+		unsigned char* out = dst + static_cast<size_t>(y) * dw * 4;
+		int x = 0;
+#if defined(__SSE2__)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i two = _mm_set1_epi16(2);
+		// 4 source pixels of each row -> 2 destination pixels, as long as the 4 are inside the row
+		for (; 2 * x + 3 < width && x + 1 < dw; x += 2) {
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));	// pixels 0, 1
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));	// pixels 2, 3
+			lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+			__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), two), 2);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, zero));
+		}
+#endif
+		for (; x < dw; x++) {
+			int x0 = std::min(2 * x, width - 1) * 4;
+			int x1 = std::min(2 * x + 1, width - 1) * 4;
+			boxPixel(row0 + x0, row0 + x1, row1 + x0, row1 + x1, out + 4 * x);
+		}
+	}
+}
+
+/// @brief build every level after the first of the image mip chain in image.mips. No GL call, runs on the decoding worker
+/// @param image decoded RGBA image
+void buildMipChain(TextureImage& image) {
+	int levels = mipLevelCount(image.width, image.height);
+	size_t base = mipLevelOffset(image.width, image.height, 1);
+	image.mips.resize(mipLevelOffset(image.width, image.height, levels) - base);
+
+	const unsigned char* src = image.data.get();
+	int w = image.width, h = image.height;
+	for (int l = 1; l < levels; l++) {
+		unsigned char* dst = image.mips.data() + mipLevelOffset(image.width, image.height, l) - base;
+		downsampleBox(src, w, h, dst);
+		src = dst;
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+}
+
+/// @brief number of levels the image has on the CPU: all of them when read from a .scoptex or built by buildMipChain, else only the first
+int TextureImage::levelCount() const {
+	if (containerPixels)
+		return containerLevels;
+	return mips.empty() ? 1 : mipLevelCount(width, height);
+}
+
+/// @brief pixels of a level, l < levelCount()
+const unsigned char* TextureImage::level(int l) const {
+	if (containerPixels)
+		return containerPixels + mipLevelOffset(width, height, l);
+	if (l == 0)
+		return data.get();
+	return mips.data() + mipLevelOffset(width, height, l) - mipLevelOffset(width, height, 1);
+}
+
+//________________ uploads _____________________//
+
+/// @brief the uploader of the program
+TextureUploader& TextureUploader::instance() {
+	static TextureUploader uploader;
+	return uploader;
+}
+
+/// @brief send every level of a decoded image to the bound GL_TEXTURE_2D: through a PBO unless setup.pboUploads is false,
+/// and with glGenerateMipmap when the image only has its first level
+/// @param image decoded image, with or without its mip chain
+void TextureUploader::upload(const TextureImage& image) {
+	int levels = image.levelCount();
+	size_t total = mipLevelOffset(image.width, image.height, levels);
+
+	if (!setup.pboUploads || !uploadPBO(image, levels, total))
+		uploadDirect(image, levels);
+	if (levels == 1)
+		glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+/// @brief copy the levels in the next PBO of the ring and let glTexImage2D read them from it
+/// @return false if the PBO could not be mapped (nothing was uploaded)
+bool TextureUploader::uploadPBO(const TextureImage& image, int levels, size_t total) {
+	int slot = _next;
+	_next = (_next + 1) % PBO_COUNT;
+
+	// the previous upload from this PBO must be done before its memory is written again
+	if (_fences[slot]) {
+		glClientWaitSync(_fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(_fences[slot]);
+		_fences[slot] = nullptr;
+	}
+	if (!_pbos[slot])
+		glGenBuffers(1, &_pbos[slot]);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pbos[slot]);
+	if (_capacity[slot] < total) {
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+		_capacity[slot] = total;
+	}
+
+	unsigned char* dst = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	if (!dst) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+	for (int l = 0; l < levels; l++) {
+		size_t offset = mipLevelOffset(image.width, image.height, l);
+		memcpy(dst + offset, image.level(l), mipLevelOffset(image.width, image.height, l + 1) - offset);
+	}
+	if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+
+	int w = image.width, h = image.height;
+	for (int l = 0; l < levels; l++) {
+		glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			reinterpret_cast<const void*>(mipLevelOffset(image.width, image.height, l)));
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+	_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	return true;
+}
+
+/// @brief plain glTexImage2D of each level from client memory
+void TextureUploader::uploadDirect(const TextureImage& image, int levels) {
+	int w = image.width, h = image.height;
+	for (int l = 0; l < levels; l++) {
+		glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.level(l));
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+}
+
+/// @brief delete the PBOs and fences, to call while the GL context still exists
+void TextureUploader::release() {
+	for (int i = 0; i < PBO_COUNT; i++) {
+		if (_fences[i])
+			glDeleteSync(_fences[i]);
+		if (_pbos[i])
+			glDeleteBuffers(1, &_pbos[i]);
+		_fences[i] = nullptr;
+		_pbos[i] = 0;
+		_capacity[i] = 0;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Texture.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// CPU mip chain (TextureUpload.cpp)
+void	downsampleBox(const unsigned char* src, int width, int height, unsigned char* dst);
+void	buildMipChain(TextureImage& image);
+int		mipLevelCount(int width, int height);
+size_t	mipLevelOffset(int width, int height, int level);
+
+/**
+ * @brief uploads decoded images to the bound GL texture through a ring of pixel buffer objects.
+ *
+ * The pixels are copied in a mapped PBO and glTexImage2D reads them from it, so the call returns once the copy is queued
+ * and the driver does the transfer on its own. Each PBO is fenced after use and the ring waits on the fence before reusing it,
+ * the buffers are kept (and only grown) from one upload to the next. GL thread only.
+ */
+class TextureUploader {
+	public:
+		static TextureUploader& instance();
+
+		void	upload(const TextureImage& image);
+		void	release();
+
+	private:
+		static const int	PBO_COUNT = 4;
+
+		GLuint	_pbos[PBO_COUNT] = {};
+		size_t	_capacity[PBO_COUNT] = {};
+		GLsync	_fences[PBO_COUNT] = {};
+		int		_next = 0;
+
+		TextureUploader() = default;
+		bool	uploadPBO(const TextureImage& image, int levels, size_t total);
+		void	uploadDirect(const TextureImage& image, int levels);
+};
@@ -0,0 +1,45 @@
+#include "ThreadPool.hpp"
+
+/// @brief start the workers
+/// @param threads number of workers, 0 to use one per hardware thread
+ThreadPool::ThreadPool(unsigned int threads) : _stop(false) {
+	if (threads == 0)
+		threads = hardwareThreads();
+	for (unsigned int i = 0; i < threads; i++)
+		_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+/// @brief let the workers empty the queue then join them
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_cond.notify_all();
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+/// @brief worker body: wait for a task, run it, repeat until the pool is stopped and the queue empty
+void ThreadPool::workerLoop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+			if (_tasks.empty())
+				return;
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+		task();
+	}
+}
+
+size_t ThreadPool::size() const {return _workers.size();}
+
+/// @brief number of hardware threads, at least 1
+unsigned int ThreadPool::hardwareThreads() {
+	unsigned int n = std::thread::hardware_concurrency();
+	return n ? n : 1;
+}
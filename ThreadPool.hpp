@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+/**
+ * @brief Fixed size pool of worker threads consuming a FIFO of tasks.
+ *
+ * submit() returns a std::future so the caller can wait on the result and get back any exception thrown by the task.
+ * The destructor finishes the queued tasks before joining the workers.
+ */
+class ThreadPool {
+	public:
+		ThreadPool(unsigned int threads = 0);
+		ThreadPool(const ThreadPool& oth) = delete;
+		ThreadPool& operator=(const ThreadPool& oth) = delete;
+		~ThreadPool();
+
+		/// @brief queue a task for the workers
+		/// @param task callable without parameters
+		/// @return future of the task result
+		template<typename F>
+		auto submit(F&& task) -> std::future<decltype(task())> {
+			using R = decltype(task());
+			auto job = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+			std::future<R> res = job->get_future();
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_tasks.push([job]() { (*job)(); });
+			}
+			_cond.notify_one();
+			return res;
+		}
+
+		size_t size() const;
+		static unsigned int hardwareThreads();
+
+	private:
+		std::vector<std::thread>			_workers;
+		std::queue<std::function<void()>>	_tasks;
+		std::mutex							_mutex;
+		std::condition_variable				_cond;
+		bool								_stop;
+
+		void workerLoop();
+};
@@ -0,0 +1,121 @@
+#include "UniformBuffers.hpp"
+#include "GLState.hpp"
+#include "Includes/header.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+//________________ FrameUniforms _____________________//
+
+/// @brief the Frame block of the program
+FrameUniforms& FrameUniforms::instance() {
+	static FrameUniforms frame;
+	return frame;
+}
+
+/// @brief write the matrices of the frame and the light of setup to the Frame block, created and bound on first use
+/// @param view camera matrix
+/// @param projection perspective matrix
+void FrameUniforms::update(const mat4& view, const mat4& projection) {
+	FrameBlock block;
+	std::memcpy(block.view, view.data, sizeof(block.view));
+	std::memcpy(block.projection, projection.data, sizeof(block.projection));
+	for (int i = 0; i < 3; i++) {
+		block.lightPos[i] = setup.lightPos[i];
+		block.lightColor[i] = setup.lightColor[i];
+		block.viewPos[i] = setup.viewPos[i];
+	}
+	block.lightPos[3] = block.lightColor[3] = block.viewPos[3] = 0.f;
+
+	if (!_buffer) {
+		glGenBuffers(1, &_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, _buffer);
+	}
+	else
+		glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLState::instance().count(2);
+	GLState::instance().countUniform();
+}
+
+/// @brief delete the buffer, to call while the GL context still exists
+void FrameUniforms::release() {
+	if (_buffer)
+		glDeleteBuffers(1, &_buffer);
+	_buffer = 0;
+}
+
+//________________ MaterialTable _____________________//
+
+/// @brief default constructor, the buffer is created by build
+MaterialTable::MaterialTable() {}
+
+/// @brief delete the buffer
+MaterialTable::~MaterialTable() {
+	if (_buffer)
+		glDeleteBuffers(1, &_buffer);
+}
+
+/**
+ * @brief give each Material its row (Material::tableIndex) and upload the rows, to call again whenever a Material is added
+ * @param materials Materials of the Model, by name
+ */
+void MaterialTable::build(std::unordered_map<std::string, Material>& materials) {
+	if (!_pageStride) {
+		GLint alignment = 1;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		size_t page = MATERIAL_TABLE_SIZE * sizeof(MaterialBlock);
+		_pageStride = (page + alignment - 1) / alignment * alignment;
+	}
+	// whole pages: the range bound is always the size of the block
+	size_t pages = (materials.size() + MATERIAL_TABLE_SIZE - 1) / MATERIAL_TABLE_SIZE;
+	std::vector<unsigned char> data(std::max<size_t>(pages, 1) * _pageStride, 0);
+
+	size_t index = 0;
+	for (auto& it : materials) {
+		Material& mat = it.second;
+		mat.tableIndex = index++;
+		MaterialBlock row = {
+			{mat.ambient[0], mat.ambient[1], mat.ambient[2]}, mat.shininess,
+			{mat.diffuse[0], mat.diffuse[1], mat.diffuse[2]}, mat.opacity,
+			{mat.specular[0], mat.specular[1], mat.specular[2]}, 0.f,
+		};
+		size_t offset = mat.tableIndex / MATERIAL_TABLE_SIZE * _pageStride + mat.tableIndex % MATERIAL_TABLE_SIZE * sizeof(MaterialBlock);
+		std::memcpy(data.data() + offset, &row, sizeof(row));
+	}
+	_size = materials.size();
+
+	if (!_buffer)
+		glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	// bind the range again over the new storage
+	GLState::instance().invalidate();
+}
+
+/// @brief forget the uploaded rows, the next build uploads them again (the Materials were replaced)
+void MaterialTable::invalidate() {
+	_size = 0;
+}
+
+/// @brief bind a page of rows to the Materials block
+/// @param page index of the page, the rows from page * MATERIAL_TABLE_SIZE
+void MaterialTable::bindPage(size_t page) const {
+	GLState::instance().bindUniformBuffer(MATERIAL_BLOCK_BINDING, _buffer, page * _pageStride, MATERIAL_TABLE_SIZE * sizeof(MaterialBlock));
+}
+
+/// @brief select the row of a Material for the next draws: the page holding it, then its index in the page
+/// @param shader program shader linked to the model
+/// @param material Material of the Mesh(es) about to be drawn, with its row in this table
+void MaterialTable::use(Shader& shader, const Material& material) const {
+	bindPage(material.tableIndex / MATERIAL_TABLE_SIZE);
+	shader.set(shader.uniforms.materialIndex, static_cast<int>(material.tableIndex % MATERIAL_TABLE_SIZE));
+}
+
+//getters
+size_t MaterialTable::size() const {return _size;}
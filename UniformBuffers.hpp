@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Shader.hpp"
+#include "Includes/struct.hpp"
+#include <string>
+#include <unordered_map>
+
+static const GLuint	FRAME_BLOCK_BINDING = 0;	// binding point of the Frame uniform block
+static const GLuint	MATERIAL_BLOCK_BINDING = 1;	// binding point of the Materials uniform block
+static const size_t	MATERIAL_TABLE_SIZE = 256;	// rows of the Materials block, 12 KB: under the 16 KB GL_MAX_UNIFORM_BLOCK_SIZE minimum
+
+// std140 layout of the Frame block of the model shaders (row_major, as vml stores its matrices)
+struct FrameBlock {
+	float	view[16];
+	float	projection[16];
+	float	lightPos[4];
+	float	lightColor[4];
+	float	viewPos[4];
+};
+
+// std140 layout of one row of the Materials block of the model shaders
+struct MaterialBlock {
+	float	ambient[3];
+	float	shininess;
+	float	diffuse[3];
+	float	opacity;
+	float	specular[3];
+	float	pad;
+};
+
+/**
+ * @brief the uniform buffer of the Frame block: camera matrices and light, written once per frame (defineMatrices) and
+ * read by every draw of every shader, whatever the number of Meshes. GL thread only.
+ */
+class FrameUniforms {
+	public:
+		static FrameUniforms& instance();
+
+		void	update(const mat4& view, const mat4& projection);
+		void	release();
+
+	private:
+		GLuint	_buffer = 0;
+
+		FrameUniforms() = default;
+};
+
+/**
+ * @brief the colours of every Material of a Model in one uniform buffer, uploaded when a Material is added and indexed by
+ * the shaders (materialIndex): switching Material costs one glUniform1i instead of five uniforms.
+ *
+ * The rows are in pages of MATERIAL_TABLE_SIZE, the size of the Materials block: a Model with more Materials binds the
+ * page of the next Material when it changes (glBindBufferRange), which GLState skips while it stays the same. GL thread only.
+ */
+class MaterialTable {
+	public:
+		MaterialTable();
+		MaterialTable(const MaterialTable& oth) = delete;
+		MaterialTable& operator=(const MaterialTable& oth) = delete;
+		~MaterialTable();
+
+		void	build(std::unordered_map<std::string, Material>& materials);
+		void	invalidate();
+		void	bindPage(size_t page) const;
+		void	use(Shader& shader, const Material& material) const;
+
+		//getters
+		size_t	size() const;
+
+	private:
+		GLuint	_buffer = 0;
+		size_t	_size = 0;			// rows uploaded
+		size_t	_pageStride = 0;	// bytes between two pages, a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// 0-based indices of a face point (v, vt, vn), vt and vn are negative when absent
+struct VertexKey {
+    int v, vt, vn;
+    bool operator==(VertexKey const& o) const noexcept {
+        return v == o.v && vt == o.vt && vn == o.vn;
+    }
+};
+
+/**
+ * @brief Open-addressing hash map VertexKey -> Mesh vertex index used to deduplicate the face points of a Mesh.
+ *
+ * One flat array of slots with linear probing: no allocation per vertex, a lookup is most of the time a single cache line.
+ * A slot is empty when its v is -1 (a real key always has a position index >= 0). The table doubles past 70% load.
+ */
+class VertexCache {
+	public:
+		VertexCache(size_t expected = 0) : _size(0), _mask(0) {reserve(expected);}
+
+		/// @brief make room for expected keys without rehashing
+		void reserve(size_t expected) {
+			size_t capacity = MIN_CAPACITY;
+			while (capacity * MAX_LOAD_NUM < expected * MAX_LOAD_DEN)
+				capacity *= 2;
+			if (capacity > _slots.size())
+				rehash(capacity);
+		}
+
+		/// @brief remove every key. The table keeps its size unless it is far bigger than what the last Mesh needed,
+		/// so a long run of small groups after a big one does not pay for clearing the big table each time
+		void clear() {
+			size_t used = _size;
+			_size = 0;
+			if (_slots.size() > MIN_CAPACITY && used * SHRINK_RATIO < _slots.size()) {
+				_slots.assign(MIN_CAPACITY, Slot{EMPTY, 0, 0, 0});
+				_mask = MIN_CAPACITY - 1;
+				reserve(used);
+			}
+			else
+				std::fill(_slots.begin(), _slots.end(), Slot{EMPTY, 0, 0, 0});
+		}
+
+		/// @brief look a key up and insert it with the candidate index if it is not there
+		/// @param key face point key
+		/// @param candidate index to store if the key is new (the index the new vertex will get)
+		/// @return the index stored for the key, candidate if it was just inserted
+		unsigned int findOrInsert(const VertexKey& key, unsigned int candidate) {
+			if ((_size + 1) * MAX_LOAD_DEN > _slots.size() * MAX_LOAD_NUM)
+				rehash(_slots.size() * 2);
+			size_t i = hash(key) & _mask;
+			while (true) {
+				Slot& slot = _slots[i];
+				if (slot.v == EMPTY) {
+					slot = Slot{key.v, key.vt, key.vn, candidate};
+					_size++;
+					return candidate;
+				}
+				if (slot.v == key.v && slot.vt == key.vt && slot.vn == key.vn)
+					return slot.index;
+				i = (i + 1) & _mask;
+			}
+		}
+
+		size_t size() const {return _size;}
+		size_t capacity() const {return _slots.size();}
+
+	private:
+		struct Slot {
+			int				v, vt, vn;
+			unsigned int	index;
+		};
+
+		static const int	EMPTY = -1;
+		static const size_t	MIN_CAPACITY = 64;
+		static const size_t	MAX_LOAD_NUM = 7;	// max load factor 7/10
+		static const size_t	MAX_LOAD_DEN = 10;
+		static const size_t	SHRINK_RATIO = 16;
+
+		std::vector<Slot>	_slots;
+		size_t				_size;
+		size_t				_mask;
+
+		/// @brief murmur3 64 bits finalizer over the three indices, every input bit affects every output bit
+		/// so regular index patterns (grids, strips) spread over the whole table
+		static uint64_t hash(const VertexKey& key) {
+			uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(key.v)) << 32 | static_cast<uint32_t>(key.vt))
+				^ (static_cast<uint64_t>(static_cast<uint32_t>(key.vn)) * 0x9E3779B97F4A7C15ULL);
+			h ^= h >> 33;
+			h *= 0xFF51AFD7ED558CCDULL;
+			h ^= h >> 33;
+			h *= 0xC4CEB9FE1A85EC53ULL;
+			h ^= h >> 33;
+			return h;
+		}
+
+		void rehash(size_t capacity) {
+			std::vector<Slot> old(capacity, Slot{EMPTY, 0, 0, 0});
+			old.swap(_slots);
+			_mask = capacity - 1;
+			for (const Slot& slot : old) {
+				if (slot.v == EMPTY)
+					continue;
+				size_t i = hash(VertexKey{slot.v, slot.vt, slot.vn}) & _mask;
+				while (_slots[i].v != EMPTY)
+					i = (i + 1) & _mask;
+				_slots[i] = slot;
+			}
+		}
+};
@@ -2,10 +2,18 @@
 #include "Includes/vml.hpp"
 #include "Camera.hpp"
 #include "Model.hpp"
+#include "TextureUpload.hpp"
+#include "TextureContainer.hpp"
+#include "GLExtensions.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "Benchmark.hpp"
 
 #include "Includes/imgui/imgui.h"
 #include "Includes/imgui/imgui_impl_glfw.h"
 #include "Includes/imgui/imgui_impl_opengl3.h"
+#include <chrono>
+#include <thread>
 
 
 using namespace vml;
@@ -35,47 +43,233 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 }
 
 
-/** @brief set a Custom Texture to the program, or a dafault one.
- * 
+/** @brief split the program arguments between the positional ones (object and texture paths) and the '--option=value' ones that set the Setup struct.
+ *
+ *	Options:
+ *	--loader=stream|mmap	.obj parser to use (default mmap)
+ *	--threads=N				threads of the mmap parser and of the normal / UV generation, 0 for one per hardware thread (default), 1 for the serial one
+ *	--no-cache				always parse the .obj, do not read nor write the .scopbin cache
+ *	--cache-dir=DIR			put the .scopbin and .scopprog caches in DIR instead of next to the models and shaders
+ *	--no-shader-cache		always compile the shaders, do not read nor write their .scopprog program binaries
+ *	--progressive			parse the .obj on a worker thread and draw each group as soon as it is parsed
+ *	--no-pbo				upload the textures straight from client memory instead of through pixel buffer objects
+ *	--gpu-mipmaps			let glGenerateMipmap build the texture mip chains instead of the decoding workers
+ *	--no-mesh-opt			keep the triangles and vertices in the .obj order, do not optimize them for the vertex cache
+ *	--packed-vertices		upload the vertices as PackedVertex (16 bits positions and normals, half float UVs) instead of floats
+ *	--indirect-draw			submit all the meshes with glMultiDrawElementsIndirect (one by one from a prebuilt list on a 3.3 context)
+ *	--no-scoptex			always decode the image files, ignore their .scoptex containers
+ *	--convert-textures		write the .scoptex of every image given in parameter and exit
+ *	--profile-csv=PATH		file the "Dump CSV" button of the profiler panel writes the last frames to (default scop_profile.csv)
+ *	--bench[=N]				render N frames (default 300) of a camera orbit offscreen, print their timings as JSON and exit (see runBenchmark)
+ *	--bench-images=DIR		with --bench, save 8 frames of the orbit as .ppm in DIR
+ *
  *	@param argc number of argument given when the program is launch (main parameters)
  *	@param argv arguments given when the program is launch (main parameters)
  *	@param log out stream for the log messages
+ *	@return the positional arguments, without the program name
+*/
+std::vector<std::string> parseArgs(int argc, char **argv, std::ostream& log) {
+	std::vector<std::string> args;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg.rfind("--", 0) != 0) {
+			args.push_back(arg);
+			continue;
+		}
+		std::string key = arg.substr(0, arg.find('='));
+		std::string value = arg.find('=') < arg.size() ? arg.substr(arg.find('=') + 1) : "";
+		if (key == "--loader" && (value == "stream" || value == "mmap"))
+			setup.loader = value == "stream" ? streamed : mapped;
+		else if (key == "--threads" && !value.empty() && value.size() <= 4 && value.find_first_not_of("0123456789") == std::string::npos)
+			setup.loaderThreads = std::stoul(value);
+		else if (key == "--no-cache")
+			setup.useCache = false;
+		else if (key == "--cache-dir" && !value.empty())
+			setup.cacheDir = value;
+		else if (key == "--no-shader-cache")
+			setup.shaderCache = false;
+		else if (key == "--progressive")
+			setup.progressiveLoad = true;
+		else if (key == "--no-pbo")
+			setup.pboUploads = false;
+		else if (key == "--gpu-mipmaps")
+			setup.cpuMipmaps = false;
+		else if (key == "--no-mesh-opt")
+			setup.optimizeMeshes = false;
+		else if (key == "--packed-vertices")
+			setup.packedVertices = true;
+		else if (key == "--indirect-draw")
+			setup.indirectDraw = true;
+		else if (key == "--no-scoptex")
+			setup.textureContainers = false;
+		else if (key == "--convert-textures")
+			setup.convertTextures = true;
+		else if (key == "--profile-csv" && !value.empty())
+			setup.profileCsv = value;
+		else if (key == "--bench" && value.empty())
+			setup.benchFrames = BENCH_DEFAULT_FRAMES;
+		else if (key == "--bench" && value.size() <= 6 && value.find_first_not_of("0123456789") == std::string::npos && std::stoul(value) > 0)
+			setup.benchFrames = std::stoul(value);
+		else if (key == "--bench-images" && !value.empty())
+			setup.benchImages = value;
+		else
+			log << "Unknown or invalid option ignored: " << arg << std::endl;
+	}
+	return args;
+}
+
+/** @brief --convert-textures mode: write the .scoptex container of each image (see writeTextureContainer), with the default TextureConfig
+ *
+ *	@param args image paths
+ *	@param log out stream for the log messages
+ *	@return the exit status of the program, 0 if every image was converted
 */
-void setupCustomTexture(int argc, char **argv, std::ostream& log) {
-	if (argc < 3)
+int convertTextures(const std::vector<std::string>& args, std::ostream& log) {
+	int status = 0;
+	for (const std::string& path : args) {
+		try {
+			auto start = std::chrono::steady_clock::now();
+			std::string out = writeTextureContainer(path);
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			log << "Converted " << path << " to " << out << " in " << elapsed.count() << " ms" << std::endl;
+		} catch (std::exception& e) {
+			log << e.what() << std::endl;
+			std::cerr << e.what() << std::endl;
+			status = 1;
+		}
+	}
+	return status;
+}
+
+/** @brief set a Custom Texture to the program, or a dafault one.
+ * 
+ *	@param args positional arguments given when the program is launch (see parseArgs)
+ *	@param log out stream for the log messages
+*/
+void setupCustomTexture(const std::vector<std::string>& args, std::ostream& log) {
+	if (args.size() < 2)
 		setup.custom.loadTexture("Textures/BlackLodge.png");
 	else{
-		setup.custom.loadTexture(argv[2]);
+		setup.custom.loadTexture(args[1]);
 		log << "You have inserted a custom Texture Path. Be warned that it might not appears correctly depending on the Texture selected" <<std::endl;
 	}
 }
 
+/**
+ * @brief log the vertex cache statistics (ACMR / ATVR, see VertexCacheStats) of the parsed and optimized index orders of a Model,
+ * nothing when it was loaded from the .scopbin cache
+ *
+ * @param object loaded Model
+ * @param log out stream for the log messages
+ */
+void logVertexCacheStats(Model& object, std::ostream& log) {
+	VertexCacheStats before = object.vertexCacheStats(false);
+	VertexCacheStats after = object.vertexCacheStats(true);
+	if (!before.triangles)
+		return;
+	log << "Vertex cache (FIFO " << VERTEX_CACHE_SIZE << "), " << before.triangles << " triangles: ACMR " << before.acmr();
+	if (after.triangles)
+		log << " -> " << after.acmr() << ", ATVR " << before.atvr() << " -> " << after.atvr() << std::endl;
+	else
+		log << ", ATVR " << before.atvr() << " (not optimized)" << std::endl;
+}
+
+/**
+ * @brief upload the Meshes a progressive load finished and the textures decoded since the last frame, refit the model matrix
+ * to the new bounds and log the time to the first Meshes, to the end of the parsing and to the last texture
+ *
+ * @param window glfw window pointer.
+ * @param object displayed Model
+ * @param loadStart time the load was started
+ * @param log out stream for the log messages
+ */
+void pollModelLoad(GLFWwindow *window, Model& object, std::chrono::steady_clock::time_point loadStart, std::ostream& log) {
+	size_t before = object.ms();
+	bool streaming = object.streaming();
+	if (object.pollLoad() > 0)
+		setBaseModelMatrix(window, object, false);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - loadStart;
+	if (before == 0 && object.ms() > 0)
+		log << "First meshes drawn after " << elapsed.count() << " ms" << std::endl;
+	if (streaming && !object.streaming()) {
+		log << "Kodel created Successfully in " << elapsed.count() << " ms (progressive "
+			<< (setup.loader == streamed ? "stream" : "mmap") << " loader, " << object.ms() << " meshes)" << std::endl;
+		logVertexCacheStats(object, log);
+	}
+	if (!object.loading()) {
+		log << "Textures loaded after " << elapsed.count() << " ms (" << (setup.pboUploads ? "PBO" : "direct") << " uploads, "
+			<< (setup.cpuMipmaps ? "CPU" : "GPU") << " mipmaps)" << std::endl;
+		for (auto& t : object.textureTimings())
+			log << "\t" << t.path << " " << t.width << "x" << t.height << ": decode " << t.decodeMs << " ms, mipmaps "
+				<< t.mipMs << " ms, upload " << t.uploadMs << " ms" << std::endl;
+	}
+}
+
+/**
+ * @brief --bench mode: finish the load (progressive parsing, textures) before the measured frames, see pollModelLoad
+ *
+ * @param window glfw window pointer.
+ * @param object Model being loaded
+ * @param modelMs time of the Model constructor
+ * @param loadStart time the load was started
+ * @param log out stream for the log messages
+ * @return the times of the load
+ */
+BenchLoad waitModelLoad(GLFWwindow *window, Model& object, double modelMs, std::chrono::steady_clock::time_point loadStart, std::ostream& log) {
+	while (object.loading()) {
+		pollModelLoad(window, object, loadStart, log);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::chrono::duration<double, std::milli> readyTime = std::chrono::steady_clock::now() - loadStart;
+	return {modelMs, readyTime.count()};
+}
+
 /**
  * @brief rendering loop function that will, in order: call functions to process input, redefine based on input the model matrix, draw each meshes in the model and redraw the UI imgui window.
  * 
  * @param window glfw window pointer.
- * @param shader shader class needed beforehand to draw the meshes with and send update to the program on the model.
+ * @param shaders variants of the model shader, compiled beforehand for the default one, to draw the meshes with.
+ * @param object displayed Model, possibly still loading (see pollModelLoad)
+ * @param loadStart time the load was started
+ * @param log out stream for the log messages
  */
-void renderLoop(GLFWwindow *window, Shader& shader, Model& object) {
+void renderLoop(GLFWwindow *window, ShaderVariants& shaders, Model& object, std::chrono::steady_clock::time_point loadStart, std::ostream& log) {
 	
 	while(!glfwWindowShouldClose(window))
 	{
 		float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame; 
-		processInput(window, object);
-		// Set the clear color (RGBA)
-		glClearColor(0.75, 0.75f, 0.6f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		shader.use();
-		defineMatrices(shader);
-		
-		object.Draw(shader);
-		
-		createUIImgui();
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-		
+		// before GLState::beginFrame, the GL calls of the previous frame go to its record
+		Profiler::instance().beginFrame();
+		GLState::instance().beginFrame();
+		{
+			Profiler::Scope scope(PROFILE_INPUT);
+			if (object.loading())
+				pollModelLoad(window, object, loadStart, log);
+			processInput(window, object);
+		}
+		{
+			Profiler::Scope scope(PROFILE_MATRICES, true);
+			// Set the clear color (RGBA)
+			glClearColor(0.75, 0.75f, 0.6f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			defineMatrices();
+		}
+		{
+			Profiler::Scope scope(PROFILE_DRAW, true);
+			object.Draw(shaders);
+		}
+		{
+			Profiler::Scope scope(PROFILE_UI, true);
+			createUIImgui(object);
+		}
+		{
+			Profiler::Scope scope(PROFILE_SWAP);
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
 	}
 }
 
@@ -110,9 +304,17 @@ void setupOpenGL(GLFWwindow *window) {
  *	@param window the GLFW window pointer
  */
 void cleanProgram(GLFWwindow *window) {
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	// last reference to the custom texture and the upload and uniform buffers, release them while the GL context still exists
+	setup.custom.deleteTex();
+	TextureUploader::instance().release();
+	FrameUniforms::instance().release();
+	Profiler::instance().release();
+	// no ImGui with --bench
+	if (ImGui::GetCurrentContext()) {
+		ImGui_ImplOpenGL3_Shutdown();
+		ImGui_ImplGlfw_Shutdown();
+		ImGui::DestroyContext();
+	}
 
 	glfwDestroyWindow(window);
 	glfwTerminate();
@@ -128,17 +330,23 @@ void setObjName(std::string arg) {
 
 int main(int argc, char **argv)
 {
-	std::string obj = argv[1];
 	std::ofstream log;
 	log.open("err.log");
-	log << "log file open with" << obj <<std::endl;
-	if (argc < 2){
+	std::vector<std::string> args = parseArgs(argc, argv, log);
+	if (args.empty()){
 		log << "Program ended prematurely. Object needed in parameter. No more no less." << std::endl;
 		log.close();
 		return -1;
 	}
-	setObjName(argv[1]);
-	GLFWwindow* window = initWindow(setup.modelName);
+	if (setup.convertTextures) {
+		int status = convertTextures(args, log);
+		log.close();
+		return status;
+	}
+	std::string obj = args[0];
+	log << "log file open with" << obj <<std::endl;
+	setObjName(obj);
+	GLFWwindow* window = initWindow(setup.modelName, setup.benchFrames > 0);
 	if (window == NULL)
 	{
 		log << "Program ended prematurely. Failed to create GLFW window." << std::endl;
@@ -158,19 +366,35 @@ int main(int argc, char **argv)
 		return -1;
 	}
 	
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	int status = 0;
 	try {
-		log << "Glad loaded successfully" << std::endl;
-		setupOpenGL(window);
-		log << "OpenGL setuped" << std::endl;
-		setupCustomTexture(argc, argv, log);
+		log << "Glad loaded successfully (OpenGL " << glExtensions.major << "." << glExtensions.minor
+			<< (glExtensions.multiDrawIndirect ? ", glMultiDrawElementsIndirect" : "") << ")" << std::endl;
+		if (!setup.benchFrames) {
+			setupOpenGL(window);
+			log << "OpenGL setuped" << std::endl;
+		}
+		setupCustomTexture(args, log);
 		log << "Custom Texture " <<  setup.custom.path() << " Loaded Successfully" << std::endl;
 
-		Shader shad("ShadersFiles/FinalVertexTexShad.glsl", "ShadersFiles/FinalFragTexShad.glsl");
-		log << "Shader created Successfully" << std::endl;
-		Model object = Model((char *)obj.c_str());
-		log << "Kodel created Successfully" << std::endl;
+		ShaderVariants shaders("ShadersFiles/FinalVertexTexShad.glsl", "ShadersFiles/FinalFragTexShad.glsl");
+		log << "Shader created Successfully" << (shaders.get(0u).fromCache() ? " (.scopprog program binary)" : "") << std::endl;
+		auto loadStart = std::chrono::steady_clock::now();
+		Model object = Model((char *)obj.c_str(), setup.progressiveLoad);
+		std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+		if (object.streaming())
+			log << "Kodel loading in the background" << std::endl;
+		else
+			log << "Kodel created Successfully in " << loadTime.count() << " ms ("
+				<< (object.fromCache() ? ".scopbin cache" : setup.loader == streamed ? "stream loader" : "mmap loader") << ")" << std::endl;
+		logVertexCacheStats(object, log);
 		setBaseModelMatrix(window, object);
-		renderLoop(window, shad, object);
+		if (setup.benchFrames)
+			status = runBenchmark(shaders, object, waitModelLoad(window, object, loadTime.count(), loadStart, log), log);
+		else
+			renderLoop(window, shaders, object, loadStart, log);
 	}
 	catch(std::exception& e){
 		log << "Exception catched: " << e.what() << std::endl;
@@ -180,5 +404,5 @@ int main(int argc, char **argv)
 	cleanProgram(window);
 	log << "program closed without error or exception" << std::endl;
 	log.close();
-	return 0;
+	return status;
 }
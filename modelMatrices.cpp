@@ -4,12 +4,20 @@
 /**
  * @brief set model matrix to resize and recenter the model base to fit correctly
  * @param window glfw window pointer
+ * @param resetCamera also put the camera back to its start position (false to refit a Model still loading without moving the view)
  */
-void setBaseModelMatrix(GLFWwindow* window, Model& object) {
+void setBaseModelMatrix(GLFWwindow* window, Model& object, bool resetCamera) {
 	model = identity<float,4>();
 
 	vec3 rawMin = object.min();
 	vec3 rawMax = object.max();
+	// nothing loaded yet (progressive load), keep the identity
+	if (rawMin[0] > rawMax[0]) {
+		center = vec3{0.f, 0.f, 0.f};
+		if (resetCamera)
+			camera.resetCamera(window);
+		return;
+	}
 
 	vec3 rawCenter = (rawMin + rawMax) * 0.5f;
 	vec3 rawSize = rawMax - rawMin;
@@ -25,21 +33,17 @@ void setBaseModelMatrix(GLFWwindow* window, Model& object) {
 
 	vec4 normalizedCenter4 = normalization * vec4(rawCenter, 1.0f);
 	center = vec3({normalizedCenter4[0], normalizedCenter4[1], normalizedCenter4[2]});
-	camera.resetCamera(window);
+	if (resetCamera)
+		camera.resetCamera(window);
 }
 
 /**
- * @brief (re)define view and projection matrices and export them with the model to the shader program
- * @param shad shader class used by the program
+ * @brief (re)define view and projection matrices and write them with the light to the Frame block (FrameUniforms), shared by
+ * every shader variant. The model matrix is set with the drawing state of each variant (Mesh::setDrawState)
  */
-void defineMatrices(Shader& shad) {
+void defineMatrices() {
 	mat4 view = camera.GetViewMatrix();
 	mat4 projection = perspective(radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1, 100.);
 
-	int viewLoc = glGetUniformLocation(shad.getID(), "view");
-	glUniformMatrix4fv(viewLoc, 1, GL_TRUE, view.data);
-	int projectionLoc = glGetUniformLocation(shad.getID(), "projection");
-	glUniformMatrix4fv(projectionLoc, 1, GL_TRUE, projection.data);
-	int modelLoc = glGetUniformLocation(shad.getID(), "model");
-	glUniformMatrix4fv(modelLoc, 1, GL_TRUE, model.data);
+	FrameUniforms::instance().update(view, projection);
 }
\ No newline at end of file
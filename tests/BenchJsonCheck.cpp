@@ -0,0 +1,144 @@
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+/*
+ * Check of the --bench output, piped to it by make bench-json: stdin must be a single JSON object (RFC 8259) and nothing else
+ * but whitespace, with the fields a CI script reads. Not run by make test, it needs a GL context.
+ */
+
+// fields of the runBenchmark report that must be there
+static const char*	REQUIRED_FIELDS[] = {"\"frames\":", "\"frame_ms\":", "\"fps\":", "\"sections_ms\":", "\"peak_rss_kb\":"};
+
+class JsonReader {
+	public:
+		explicit JsonReader(const std::string& text) : _p(text.c_str()), _end(text.c_str() + text.size()) {}
+
+		/// @brief one object then the end of the input
+		bool document() {
+			skipSpaces();
+			if (peek() != '{' || !value())
+				return false;
+			skipSpaces();
+			return _p == _end;
+		}
+		/// @brief offset of the first character not read, where the input is not valid JSON
+		size_t offset(const std::string& text) const {return static_cast<size_t>(_p - text.c_str());}
+
+	private:
+		const char*	_p;
+		const char*	_end;
+
+		char peek() const {return _p < _end ? *_p : '\0';}
+		void skipSpaces() {
+			while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r'))
+				_p++;
+		}
+		bool literal(const char* word) {
+			size_t len = std::strlen(word);
+			if (static_cast<size_t>(_end - _p) < len || std::strncmp(_p, word, len) != 0)
+				return false;
+			_p += len;
+			return true;
+		}
+		bool digits() {
+			const char* start = _p;
+			while (_p < _end && std::isdigit(static_cast<unsigned char>(*_p)))
+				_p++;
+			return _p > start;
+		}
+		bool number() {
+			if (peek() == '-')
+				_p++;
+			if (peek() == '0')
+				_p++;
+			else if (!digits())
+				return false;
+			if (peek() == '.' && (++_p, !digits()))
+				return false;
+			if (peek() == 'e' || peek() == 'E') {
+				_p++;
+				if (peek() == '+' || peek() == '-')
+					_p++;
+				return digits();
+			}
+			return true;
+		}
+		bool string() {
+			_p++;
+			while (_p < _end && *_p != '"') {
+				if (static_cast<unsigned char>(*_p) < 0x20)
+					return false;
+				if (*_p++ != '\\')
+					continue;
+				if (peek() == 'u') {
+					for (int i = 0; i < 4; i++)
+						if (!std::isxdigit(static_cast<unsigned char>(*++_p)))
+							return false;
+				}
+				else if (!std::strchr("\"\\/bfnrt", peek()) || peek() == '\0')
+					return false;
+				_p++;
+			}
+			return _p++ < _end;
+		}
+		/// @brief a '{' or '[' container, its members separated by commas
+		bool container(char close, bool object) {
+			_p++;
+			skipSpaces();
+			if (peek() == close)
+				return ++_p, true;
+			while (true) {
+				skipSpaces();
+				if (object) {
+					if (peek() != '"' || !string())
+						return false;
+					skipSpaces();
+					if (peek() != ':')
+						return false;
+					_p++;
+				}
+				if (!value())
+					return false;
+				skipSpaces();
+				if (peek() == close)
+					return ++_p, true;
+				if (peek() != ',')
+					return false;
+				_p++;
+			}
+		}
+		bool value() {
+			skipSpaces();
+			switch (peek()) {
+				case '{': return container('}', true);
+				case '[': return container(']', false);
+				case '"': return string();
+				case 't': return literal("true");
+				case 'f': return literal("false");
+				case 'n': return literal("null");
+				default: return number();
+			}
+		}
+};
+
+/// @brief exit status 0 if stdin is the JSON report of --bench alone
+int main() {
+	std::string text((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+	JsonReader reader(text);
+	if (!reader.document()) {
+		size_t at = reader.offset(text);
+		std::cerr << "BenchJsonCheck: stdout of --bench is not a single JSON object, at byte " << at << ": \""
+			<< text.substr(at > 20 ? at - 20 : 0, 60) << "\"" << std::endl;
+		return 1;
+	}
+	for (const char* field : REQUIRED_FIELDS)
+		if (text.find(field) == std::string::npos) {
+			std::cerr << "BenchJsonCheck: no " << field << " in the --bench report" << std::endl;
+			return 1;
+		}
+	std::cout << "BenchJsonCheck: OK" << std::endl;
+	return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// failed CHECKs of the test program, its exit status
+inline int checkFailures = 0;
+
+/// @brief report a failed condition with its location and what led to it, without stopping the test
+/// @param cond condition that must hold
+/// @param what streamable expression describing the case (input, values)
+#define CHECK(cond, ...) do { \
+	if (!(cond)) { \
+		if (++checkFailures <= 20) \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed: " << __VA_ARGS__ << std::endl; \
+	} \
+} while (0)
+
+/// @brief print the result of a test program and turn it into its exit status
+/// @param name name of the test program
+inline int checkReport(const char* name) {
+	if (checkFailures)
+		std::cerr << name << ": " << checkFailures << " failed checks" << std::endl;
+	else
+		std::cout << name << ": OK" << std::endl;
+	return checkFailures ? 1 : 0;
+}
+
+/// @brief best wall time of a few runs of work, for the bench programs
+/// @param runs number of runs
+/// @param work callable run each time
+/// @return milliseconds of the fastest run
+template<typename F>
+double bestMs(int runs, F work) {
+	double best = 1e300;
+	for (int i = 0; i < runs; i++) {
+		auto start = std::chrono::steady_clock::now();
+		work();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
@@ -0,0 +1,220 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+// the loaders are private, and so is the ModelStream a Model publishes its Meshes to instead of uploading them
+#define private public
+#include "../Includes/header.h"
+#undef private
+#include "Check.hpp"
+
+using namespace vml;
+
+/*
+ * loadModelStream and loadModelParallel against loadModelMapped: the chunks of loadModelParallel are made as small as the thread count allows, so that runs of faces,
+ * 'g', 'o', 'usemtl' and 'mtllib' lines fall on both sides of chunk boundaries, and the Meshes, Materials, bounds and name
+ * must be the same. Neither Model touches GL: they publish to a ModelStream like the worker of a progressive load.
+ * Links the objects of the program (make builds them first).
+ */
+
+// globals of main.cpp
+const unsigned int	SCR_WIDTH = 1400;
+const unsigned int	SCR_HEIGHT = 1200;
+float				deltaTime = 0.0f;
+float				lastFrame = 0.0f;
+float				lastX = SCR_WIDTH / 2.0;
+float				lastY = SCR_HEIGHT / 2.0;
+Camera				camera(vec3({0.,0.,3.}));
+mat4				model;
+Setup				setup = Setup();
+vec3				center;
+
+// thread counts of loadModelParallel, 4 chunks each
+static const unsigned int	MAX_THREADS = 16;
+static const int			RANDOM_FILES = 60;
+
+static std::mt19937	rng(42);
+
+// everything a load gives, in publication order
+struct LoadResult {
+	std::vector<Mesh>		meshes;
+	std::vector<Material>	materials;
+	vec3					min, max;
+	std::string				name;
+	bool					failed = false;
+	std::string				error;
+};
+
+/// @brief load a .obj as loadModel would, with the parallel loader cut in the smallest chunks when threads is not 0
+/// @param mode loadModelStream or loadModelMapped when threads is 0
+static LoadResult load(const std::string& path, loadMode mode, unsigned int threads) {
+	LoadResult res;
+	ModelStream stream;
+	Model staging;
+	staging._sink = &stream;
+	staging.directory = path.substr(0, path.find_last_of("/"));
+	try {
+		if (mode == streamed)
+			staging.loadModelStream(path);
+		else if (threads)
+			staging.loadModelParallel(path, threads, 1);
+		else
+			staging.loadModelMapped(path);
+	} catch (std::exception& e) {
+		res.failed = true;
+		res.error = e.what();
+	}
+	res.meshes = stream.meshes;
+	res.materials = stream.materials;
+	res.min = staging._min;
+	res.max = staging._max;
+	res.name = staging._name;
+	return res;
+}
+
+static bool sameVec(const vec3& a, const vec3& b) {
+	return std::memcmp(&a, &b, sizeof(vec3)) == 0;
+}
+
+/// @brief the stream or parallel load of path gives what the mapped one gave
+static void compare(const std::string& path, const LoadResult& expected, loadMode mode, unsigned int threads) {
+	LoadResult res = load(path, mode, threads);
+	std::string what = path + (mode == streamed ? std::string(" with the stream loader") : " with " + std::to_string(threads) + " threads");
+	CHECK(res.failed == expected.failed, what << (res.failed ? " failed: " + res.error : " did not fail like the mapped loader: " + expected.error));
+	if (res.failed || expected.failed)
+		return;
+	CHECK(res.name == expected.name, what << ": name " << res.name << " instead of " << expected.name);
+	CHECK(sameVec(res.min, expected.min) && sameVec(res.max, expected.max), what << ": bounds");
+	CHECK(res.meshes.size() == expected.meshes.size(), what << ": " << res.meshes.size() << " meshes instead of " << expected.meshes.size());
+	for (size_t i = 0; i < std::min(res.meshes.size(), expected.meshes.size()); i++) {
+		Mesh& a = res.meshes[i];
+		const Mesh& b = expected.meshes[i];
+		CHECK(a.name() == b.name() && a.materialName() == b.materialName(), what << ": mesh " << i << " " << a.name() << " / "
+			<< a.materialName() << " instead of " << b.name() << " / " << b.materialName());
+		CHECK(a._vtPresent == b._vtPresent && a._vnPresent == b._vnPresent, what << ": mesh " << i << " vt / vn flags");
+		CHECK(a._indices == b._indices, what << ": mesh " << i << " indices");
+		CHECK(a._vertices.size() == b._vertices.size()
+			&& std::memcmp(a._vertices.data(), b._vertices.data(), a._vertices.size() * sizeof(Vertex)) == 0,
+			what << ": mesh " << i << " vertices");
+	}
+	CHECK(res.materials.size() == expected.materials.size(), what << ": " << res.materials.size() << " materials instead of " << expected.materials.size());
+	for (size_t i = 0; i < std::min(res.materials.size(), expected.materials.size()); i++) {
+		const Material& a = res.materials[i];
+		const Material& b = expected.materials[i];
+		CHECK(a.name == b.name && sameVec(a.ambient, b.ambient) && sameVec(a.diffuse, b.diffuse) && sameVec(a.specular, b.specular)
+			&& a.shininess == b.shininess && a.opacity == b.opacity && a.mapKdPath == b.mapKdPath && a.mapKsPath == b.mapKsPath
+			&& a.mapBumpPath == b.mapBumpPath, what << ": material " << i << " " << a.name);
+	}
+}
+
+/// @brief the stream loader and every thread count against the mapped loader
+/// @param expected what loadModelMapped gave
+static void compareAll(const std::string& path, const LoadResult& expected) {
+	compare(path, expected, streamed, 0);
+	for (unsigned int threads = 1; threads <= MAX_THREADS; threads++)
+		compare(path, expected, mapped, threads);
+}
+
+static std::string randomFloat() {
+	return std::to_string(std::uniform_real_distribution<float>(-50.f, 50.f)(rng));
+}
+
+/// @brief a face point index among count values: 1-based or negative (relative to the last one)
+static std::string randomIndex(size_t count) {
+	int id = static_cast<int>(rng() % count);
+	return std::to_string(rng() % 4 ? id + 1 : id - static_cast<int>(count));
+}
+
+/**
+ * @brief a small .obj mixing everything the loaders handle: v / vt / vn runs, faces of 3 to 5 points in the 4 point forms
+ * with positive and negative indices, g / o / usemtl switching Meshes, comments, blank and unknown lines, faces of less than 3 points
+ * @param broken add one invalid line (bad token, index out of range or unknown Material), both loaders must fail
+ */
+static std::string randomObj(bool broken) {
+	static const char* materials[] = {"red", "green", "lib:blue"};
+	std::ostringstream obj;
+	size_t v = 0, vt = 0, vn = 0;
+	int lines = 40 + rng() % 80;
+	int brokenLine = broken ? static_cast<int>(rng() % lines) : -1;
+	obj << "# random test object\nmtllib loader.mtl\n";
+	for (int l = 0; l < lines; l++) {
+		if (l == brokenLine) {
+			switch (rng() % 3) {
+				case 0: obj << "f 1 x/1 1\n"; break;
+				case 1: obj << "f " << v + 5 << " 1 1\n"; break;
+				default: obj << "usemtl missing\n"; break;
+			}
+			continue;
+		}
+		unsigned int kind = rng() % 16;
+		if (v < 3 || kind < 4) {
+			obj << "v " << randomFloat() << " " << randomFloat() << " " << randomFloat() << "\n";
+			v++;
+		}
+		else if (kind < 6) {
+			obj << "vt " << randomFloat() << " " << randomFloat() << "\n";
+			vt++;
+		}
+		else if (kind < 8) {
+			obj << "vn " << randomFloat() << " " << randomFloat() << " " << randomFloat() << "\n";
+			vn++;
+		}
+		else if (kind < 12) {
+			unsigned int form = rng() % 4;
+			if ((form & 1 && !vt) || (form & 2 && !vn))
+				form = 0;
+			obj << "f";
+			for (unsigned int p = 3 + rng() % 3; p > 0; p--) {
+				obj << " " << randomIndex(v);
+				if (form == 1)
+					obj << "/" << randomIndex(vt);
+				else if (form == 2)
+					obj << "//" << randomIndex(vn);
+				else if (form == 3)
+					obj << "/" << randomIndex(vt) << "/" << randomIndex(vn);
+			}
+			obj << "\n";
+		}
+		else if (kind == 12)
+			obj << "g group" << rng() % 4 << "\n";
+		else if (kind == 13)
+			obj << "usemtl " << materials[rng() % 3] << "\n";
+		else if (kind == 14)
+			obj << "o object" << rng() % 4 << "\n";
+		else {
+			static const char* others[] = {"# comment\n", "\n", "s off\n", "f\n", "f 1 -1\n"};
+			obj << others[rng() % 5];
+		}
+	}
+	return obj.str();
+}
+
+/// @brief the bundled models, and random objects (some invalid) written to a temporary directory
+int main() {
+	for (const char* model : {"Resources/teapot.obj", "Resources/42.obj", "Resources/Ash/Ash_Ketchum.obj"})
+		if (std::filesystem::exists(model))
+			compareAll(model, load(model, mapped, 0));
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "scop_loader_test";
+	std::filesystem::create_directories(dir);
+	std::ofstream(dir / "loader.mtl") << "newmtl red\nKd 1 0 0\nnewmtl green\nKd 0 1 0\nmap_Kd green.png\nnewmtl blue\nKd 0 0 1\nNs 10\n";
+	std::string path = (dir / "random.obj").string();
+	for (int i = 0; i < RANDOM_FILES; i++) {
+		bool broken = i % 4 == 3;
+		std::ofstream(path, std::ios::trunc) << randomObj(broken);
+		LoadResult expected = load(path, mapped, 0);
+		CHECK(expected.failed == broken, "random object " << i << (broken ? " loaded" : " failed: " + expected.error));
+		compareAll(path, expected);
+	}
+	std::filesystem::remove_all(dir);
+	return checkReport("ObjLoaderTest");
+}
@@ -0,0 +1,85 @@
+#include "../ObjTokenizer.hpp"
+#include "StreamFaceParser.hpp"
+#include "Check.hpp"
+
+#include <cstdio>
+#include <random>
+
+// face lines of the benchmark, 3 points each
+static const int	FACE_LINES = 400000;
+static const int	RUNS = 5;
+
+/**
+ * @brief 'f' lines of a .obj parsed the way the stream loader did (std::getline, a std::stringstream per line, substr + stoi per
+ * point) then the way both loaders do now (nextLine, ObjCursor, parseFaceVertex), and the face points alone with both parsers
+ */
+int main() {
+	std::mt19937 rng(42);
+	std::string text;
+	std::vector<std::string> points;
+	for (int i = 0; i < FACE_LINES; i++) {
+		text += "f";
+		for (int k = 0; k < 3; k++) {
+			std::string point = std::to_string(rng() % 500000 + 1) + "/" + std::to_string(rng() % 500000 + 1) + "/" + std::to_string(rng() % 500000 + 1);
+			text += " " + point;
+			points.push_back(point);
+		}
+		text += "\n";
+	}
+	size_t count = points.size();
+	long long expected = 0, sum = 0;
+
+	double streamLines = bestMs(RUNS, [&]() {
+		std::istringstream file(text);
+		std::string line, type, token;
+		sum = 0;
+		while (std::getline(file, line)) {
+			std::stringstream ss(line);
+			ss >> type;
+			while (ss >> token) {
+				int v, vt, vn;
+				streamFaceVertex(token, v, vt, vn);
+				sum += v + vt + vn;
+			}
+		}
+	});
+	expected = sum;
+	double cursorLines = bestMs(RUNS, [&]() {
+		const char* p = text.data();
+		const char* end = p + text.size();
+		sum = 0;
+		while (p < end) {
+			ObjCursor line = nextLine(p, end);
+			line.token();
+			for (std::string_view token = line.token(); !token.empty(); token = line.token()) {
+				int v, vt, vn;
+				parseFaceVertex(token, v, vt, vn);
+				sum += v + vt + vn;
+			}
+		}
+	});
+	if (sum != expected)
+		return fprintf(stderr, "ObjTokenizerBench: the parsers disagree\n"), 1;
+
+	double streamPoints = bestMs(RUNS, [&]() {
+		sum = 0;
+		for (const std::string& point : points) {
+			int v, vt, vn;
+			streamFaceVertex(point, v, vt, vn);
+			sum += v + vt + vn;
+		}
+	});
+	double cursorPoints = bestMs(RUNS, [&]() {
+		sum = 0;
+		for (const std::string& point : points) {
+			int v, vt, vn;
+			parseFaceVertex(point, v, vt, vn);
+			sum += v + vt + vn;
+		}
+	});
+
+	printf("ObjTokenizerBench: %zu v/vt/vn face points, ns per point (best of %d)\n", count, RUNS);
+	printf("  'f' lines    stringstream + stoi %7.1f   ObjCursor + parseFaceVertex %7.1f\n", streamLines * 1e6 / count, cursorLines * 1e6 / count);
+	printf("  points only  substr + stoi       %7.1f   parseFaceVertex             %7.1f\n", streamPoints * 1e6 / count, cursorPoints * 1e6 / count);
+	return sum == expected ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include "../ObjTokenizer.hpp"
+#include "StreamFaceParser.hpp"
+#include "Check.hpp"
+
+#include <random>
+
+// result of a face point parser: its indices, or that it threw
+struct FacePoint {
+	bool	ok;
+	int		v, vt, vn;
+
+	bool operator==(const FacePoint& o) const {
+		return ok == o.ok && (!ok || (v == o.v && vt == o.vt && vn == o.vn));
+	}
+};
+
+static std::ostream& operator<<(std::ostream& os, const FacePoint& p) {
+	if (!p.ok)
+		return os << "throws";
+	return os << p.v << "/" << p.vt << "/" << p.vn;
+}
+
+static FacePoint withStream(const std::string& token) {
+	FacePoint p{true, 0, 0, 0};
+	try {
+		streamFaceVertex(token, p.v, p.vt, p.vn);
+	} catch (std::exception&) {
+		p.ok = false;
+	}
+	return p;
+}
+
+static FacePoint withTokenizer(const std::string& token) {
+	FacePoint p{true, 0, 0, 0};
+	try {
+		parseFaceVertex(token, p.v, p.vt, p.vn);
+	} catch (std::exception&) {
+		p.ok = false;
+	}
+	return p;
+}
+
+/// @brief the single-pass parser must give the same indices as the stoi one, and reject the same tokens
+static void compareFacePoint(const std::string& token) {
+	FacePoint expected = withStream(token), got = withTokenizer(token);
+	CHECK(got == expected, "token \"" << token << "\": " << got << " instead of " << expected);
+}
+
+/// @brief ObjCursor::token must cut a line where operator>> does
+static void compareTokens(const std::string& line) {
+	std::vector<std::string> expected = streamTokens(line), got;
+	ObjCursor cursor{line.data(), line.data() + line.size()};
+	for (std::string_view token = cursor.token(); !token.empty(); token = cursor.token())
+		got.emplace_back(token);
+	CHECK(got == expected, "line \"" << line << "\": " << got.size() << " tokens instead of " << expected.size());
+}
+
+int main() {
+	// every shape of face point, and the malformed ones
+	const char* tokens[] = {
+		"1", "1/2", "1//3", "1/2/3", "-1", "-1/-2/-3", "+1/+2/+3", "0", "007/08/09",
+		"", "/", "//", "///", "1/", "1//", "1/2/", "/2", "//3", "/2/3", "1/2/3/4", "1/2/3/", "1///4",
+		"+", "-", "+-1", "-+1", "++1", "--1", "+/+/+", "1/+/3", "1/-/3",
+		"2147483647", "-2147483648", "2147483648", "-2147483649", "99999999999999999999", "1/2147483648/3",
+		"x", "1x", "1x/2y/3z", "x/2/3", "1/x/3", "1/2/x", "1.5/2.5/3.5", "1e3", "0x10", "1 /2",
+	};
+	for (const char* token : tokens)
+		compareFacePoint(token);
+
+	// random tokens over the characters a face point (or a broken one) is made of
+	std::mt19937 rng(42);
+	const std::string faceChars = "0123456789//+-x.e";
+	for (int i = 0; i < 200000; i++) {
+		std::string token(rng() % 13, ' ');
+		for (char& c : token)
+			c = faceChars[rng() % faceChars.size()];
+		compareFacePoint(token);
+	}
+
+	const char* lines[] = {"", " ", "1/2/3 4/5/6 7/8/9", "\t1//1\t2//2 \r", "  1  2   3  ", "1\v2\f3\r", "\r\r"};
+	for (const char* line : lines)
+		compareTokens(line);
+	const std::string lineChars = "12/ \t\r\v\f";
+	for (int i = 0; i < 20000; i++) {
+		std::string line(rng() % 20, ' ');
+		for (char& c : line)
+			c = lineChars[rng() % lineChars.size()];
+		compareTokens(line);
+	}
+	return checkReport("ObjTokenizerTest");
+}
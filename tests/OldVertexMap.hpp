@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../VertexCache.hpp"
+#include <unordered_map>
+
+/*
+ * Reference for the tests and benchmarks of VertexCache.hpp: the std::unordered_map and hash the loaders deduplicated the face
+ * points with before it.
+ */
+struct OldVertexKeyHash {
+	size_t operator()(VertexKey const& k) const noexcept {
+		return static_cast<size_t>(
+			(k.v * 73856093) ^ (k.vt * 19349663) ^ (k.vn * 83492791)
+		);
+	}
+};
+
+using OldVertexMap = std::unordered_map<VertexKey, unsigned int, OldVertexKeyHash>;
+
+/// @brief the findOrInsert of the old loaders: the index stored for key, candidate if it was just inserted
+inline unsigned int oldFindOrInsert(OldVertexMap& map, const VertexKey& key, unsigned int candidate) {
+	return map.emplace(key, candidate).first->second;
+}
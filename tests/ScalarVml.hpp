@@ -0,0 +1,47 @@
+#pragma once
+
+#include "vml.hpp"
+
+/*
+ * Reference for the tests and benchmarks of the vml::simd kernels: the loops of the generic templates (Matrix::operator*,
+ * Vector::dot / cross / normalize), one element at a time, which the float 4x4 and batched vec3 paths replaced.
+ */
+
+/// @brief out = a * b for row-major 4x4 float matrices, the loop of Matrix::operator*
+inline void scalarMat4Mul(const float* a, const float* b, float* out) {
+	for (int r = 0; r < 4; r++)
+		for (int c2 = 0; c2 < 4; c2++) {
+			float res = 0.f;
+			for (int c = 0; c < 4; c++)
+				res += a[r * 4 + c] * b[c * 4 + c2];
+			out[r * 4 + c2] = res;
+		}
+}
+
+/// @brief out = m * v for a row-major 4x4 float matrix, the loop of Matrix::operator*(Vector)
+inline void scalarMat4MulVec4(const float* m, const float* v, float* out) {
+	for (int r = 0; r < 4; r++) {
+		float res = 0.f;
+		for (int c = 0; c < 4; c++)
+			res += v[c] * m[r * 4 + c];
+		out[r] = res;
+	}
+}
+
+/// @brief out[i] = a[i].dot(b[i]), one vec3 at a time
+inline void scalarDot(const vml::vec3* a, const vml::vec3* b, float* out, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		out[i] = a[i].dot(b[i]);
+}
+
+/// @brief out[i] = a[i].cross(b[i]), one vec3 at a time
+inline void scalarCross(const vml::vec3* a, const vml::vec3* b, vml::vec3* out, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		out[i] = a[i].cross(b[i]);
+}
+
+/// @brief out[i] = in[i].normalize(), one vec3 at a time
+inline void scalarNormalize(const vml::vec3* in, vml::vec3* out, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		out[i] = in[i].normalize();
+}
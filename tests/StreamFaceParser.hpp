@@ -0,0 +1,48 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Reference for the tests and benchmarks of ObjTokenizer.hpp: the stream loader before the single-pass parser, a std::stringstream
+ * per line and std::substr + std::stoi per face point.
+ */
+
+/// @brief split a face point token with std::string::find / substr and read its indices with std::stoi
+/// @throw std::invalid_argument or std::out_of_range when an index is present but invalid
+inline void streamFaceVertex(const std::string& token, int &vId, int &vtId, int &vnId)
+{
+	vId = vtId = vnId = 0;
+	size_t p1 = token.find('/');
+	if (p1 == std::string::npos) {
+		vId = std::stoi(token);
+		return;
+	}
+	size_t p2 = token.find('/', p1 + 1);
+	if (p2 == std::string::npos) {
+		vId = std::stoi(token.substr(0, p1));
+		std::string a = token.substr(p1 + 1);
+		if (!a.empty()) vtId = std::stoi(a);
+		return;
+	}
+	vId = std::stoi(token.substr(0, p1));
+	if (p2 == p1 + 1) {
+		std::string b = token.substr(p2 + 1);
+		if (!b.empty()) vnId = std::stoi(b);
+	} else {
+		vtId = std::stoi(token.substr(p1 + 1, p2 - p1 - 1));
+		std::string c = token.substr(p2 + 1);
+		if (!c.empty()) vnId = std::stoi(c);
+	}
+}
+
+/// @brief tokens of a line the way the stream loader reads them (operator>> on a std::stringstream)
+inline std::vector<std::string> streamTokens(const std::string& line) {
+	std::stringstream ss(line);
+	std::vector<std::string> tokens;
+	std::string token;
+	while (ss >> token)
+		tokens.push_back(token);
+	return tokens;
+}
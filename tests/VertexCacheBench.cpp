@@ -0,0 +1,86 @@
+#include "../ObjTokenizer.hpp"
+#include "OldVertexMap.hpp"
+#include "Check.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+static const int	RUNS = 5;
+
+/// @brief face points of a w x h grid of quads split in two triangles, v = vt = vn like a .obj exported with UVs and normals
+static std::vector<VertexKey> gridKeys(int w, int h) {
+	std::vector<VertexKey> keys;
+	for (int y = 0; y < h; y++)
+		for (int x = 0; x < w; x++) {
+			int a = y * (w + 1) + x, b = a + 1, c = a + w + 1, d = c + 1;
+			for (int v : {a, b, d, a, d, c})
+				keys.push_back(VertexKey{v, v, v});
+		}
+	return keys;
+}
+
+/// @brief face points of a .obj in file order, 0-based like faceVertexKey makes them (-1 when vt / vn is absent)
+/// @return no key if the file cannot be read
+static std::vector<VertexKey> modelKeys(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	std::string text = buffer.str();
+	std::vector<VertexKey> keys;
+	int counts[3] = {};	// v, vt, vn
+	const char* p = text.data();
+	const char* end = p + text.size();
+	while (p < end) {
+		ObjCursor line = nextLine(p, end);
+		std::string_view type = line.token();
+		if (type == "v" || type == "vt" || type == "vn")
+			counts[type.size() == 1 ? 0 : type[1] == 't' ? 1 : 2]++;
+		else if (type == "f")
+			for (std::string_view token = line.token(); !token.empty(); token = line.token()) {
+				int id[3];
+				parseFaceVertex(token, id[0], id[1], id[2]);
+				for (int i = 0; i < 3; i++)
+					id[i] = id[i] > 0 ? id[i] - 1 : id[i] < 0 ? counts[i] + id[i] : -1;
+				keys.push_back(VertexKey{id[0], id[1], id[2]});
+			}
+	}
+	return keys;
+}
+
+/// @brief deduplicate keys with the old std::unordered_map then with VertexCache, as one Mesh, and print the time per lookup
+/// @return false if they did not give the same indices
+static bool bench(const char* name, const std::vector<VertexKey>& keys) {
+	if (keys.empty()) {
+		printf("  %-28s not found, skipped\n", name);
+		return true;
+	}
+	size_t unique = 0, sumMap = 0, sumCache = 0;
+	double mapMs = bestMs(RUNS, [&]() {
+		OldVertexMap map;
+		sumMap = 0;
+		for (const VertexKey& key : keys)
+			sumMap += oldFindOrInsert(map, key, static_cast<unsigned int>(map.size()));
+		unique = map.size();
+	});
+	double cacheMs = bestMs(RUNS, [&]() {
+		VertexCache cache;
+		sumCache = 0;
+		for (const VertexKey& key : keys)
+			sumCache += cache.findOrInsert(key, static_cast<unsigned int>(cache.size()));
+	});
+	printf("  %-28s %9zu %9zu %10.1f %10.1f%s\n", name, keys.size(), unique, mapMs * 1e6 / keys.size(), cacheMs * 1e6 / keys.size(),
+		sumMap == sumCache ? "" : "  MISMATCH");
+	return sumMap == sumCache;
+}
+
+/// @brief face point deduplication of the loaders: the old std::unordered_map against VertexCache, on grids and the bundled models
+int main() {
+	printf("VertexCacheBench: ns per lookup (best of %d)\n", RUNS);
+	printf("  %-28s %9s %9s %10s %10s\n", "face points", "lookups", "unique", "unordered", "VertexCache");
+	bool same = bench("grid 100x100", gridKeys(100, 100));
+	same &= bench("grid 1000x1000", gridKeys(1000, 1000));
+	for (const char* model : {"Resources/teapot.obj", "Resources/42.obj", "Resources/Ash/Ash_Ketchum.obj"})
+		same &= bench(model, modelKeys(model));
+	return same ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+// the probe invariant is checked on the slots themselves
+#define private public
+#include "../VertexCache.hpp"
+#undef private
+#include "OldVertexMap.hpp"
+#include "Check.hpp"
+
+static std::ostream& operator<<(std::ostream& os, const VertexKey& k) {
+	return os << k.v << "/" << k.vt << "/" << k.vn;
+}
+
+// keys stored before their home slot, found again after the probe wrapped around the end of the table
+static size_t wrappedKeys = 0;
+
+/**
+ * @brief linear probing invariants: the capacity is a power of two at most 70% full, size() is the number of keys, and every
+ * key is reached from its home slot without crossing an empty slot
+ */
+static void checkSlots(const VertexCache& cache) {
+	size_t capacity = cache._slots.size();
+	CHECK(capacity >= VertexCache::MIN_CAPACITY && (capacity & (capacity - 1)) == 0, "capacity " << capacity);
+	CHECK(cache._mask == capacity - 1, "mask " << cache._mask << " for capacity " << capacity);
+	CHECK(cache._size * VertexCache::MAX_LOAD_DEN <= capacity * VertexCache::MAX_LOAD_NUM, cache._size << " keys in " << capacity);
+	size_t used = 0;
+	for (size_t i = 0; i < capacity; i++) {
+		const VertexCache::Slot& slot = cache._slots[i];
+		if (slot.v == VertexCache::EMPTY)
+			continue;
+		used++;
+		size_t home = VertexCache::hash(VertexKey{slot.v, slot.vt, slot.vn}) & cache._mask;
+		if (i < home)
+			wrappedKeys++;
+		for (size_t j = home; j != i; j = (j + 1) & cache._mask)
+			CHECK(cache._slots[j].v != VertexCache::EMPTY, "key " << VertexKey{slot.v, slot.vt, slot.vn} << " unreachable from slot " << home);
+	}
+	CHECK(used == cache.size(), used << " slots used for size " << cache.size());
+}
+
+/**
+ * @brief run the same face points through VertexCache and the old std::unordered_map: both must give the same index for every
+ * point, including the rehashes at 70% load, and the table must double exactly when the next key would pass it
+ * @param keys face points, as the loaders look them up
+ * @param cache cache to fill, possibly already used and cleared
+ */
+static void compareWithMap(const std::vector<VertexKey>& keys, VertexCache& cache) {
+	OldVertexMap map;
+	for (const VertexKey& key : keys) {
+		size_t before = cache.capacity();
+		bool mustGrow = (cache.size() + 1) * VertexCache::MAX_LOAD_DEN > before * VertexCache::MAX_LOAD_NUM;
+		unsigned int candidate = static_cast<unsigned int>(map.size());
+		unsigned int expected = oldFindOrInsert(map, key, candidate);
+		unsigned int got = cache.findOrInsert(key, candidate);
+		CHECK(got == expected, "key " << key << ": index " << got << " instead of " << expected);
+		CHECK(cache.capacity() == (mustGrow ? before * 2 : before), "capacity " << before << " -> " << cache.capacity() << " at " << cache.size() << " keys");
+		if (cache.capacity() != before)
+			checkSlots(cache);
+	}
+	CHECK(cache.size() == map.size(), cache.size() << " keys instead of " << map.size());
+	checkSlots(cache);
+}
+
+/// @brief random face points over small index ranges, so most of them repeat; vt and vn are -1 when absent or any negative value
+static std::vector<VertexKey> randomKeys(std::mt19937& rng, size_t count, int range) {
+	std::vector<VertexKey> keys(count);
+	for (VertexKey& k : keys) {
+		k.v = static_cast<int>(rng() % range);
+		k.vt = rng() % 4 == 0 ? -1 : static_cast<int>(rng() % (2 * range)) - range;
+		k.vn = rng() % 4 == 0 ? -1 : static_cast<int>(rng() % (2 * range)) - range;
+	}
+	return keys;
+}
+
+/// @brief face points of a w x h grid of quads split in two triangles, v = vt = vn like a .obj exported with UVs and normals
+static std::vector<VertexKey> gridKeys(int w, int h) {
+	std::vector<VertexKey> keys;
+	for (int y = 0; y < h; y++)
+		for (int x = 0; x < w; x++) {
+			int a = y * (w + 1) + x, b = a + 1, c = a + w + 1, d = c + 1;
+			for (int v : {a, b, d, a, d, c})
+				keys.push_back(VertexKey{v, v, v});
+		}
+	return keys;
+}
+
+int main() {
+	std::mt19937 rng(42);
+
+	// growth from the minimal table, probe runs wrapping around its end while it is small
+	for (int run = 0; run < 200; run++) {
+		VertexCache cache;
+		compareWithMap(randomKeys(rng, 40 + run % 60, 8 + run % 24), cache);
+	}
+	CHECK(wrappedKeys > 0, "no probe run wrapped around the end of the table");
+
+	// many rehashes, negative vt / vn
+	{
+		VertexCache cache;
+		compareWithMap(randomKeys(rng, 300000, 200), cache);
+		compareWithMap(gridKeys(300, 300), cache = VertexCache());
+	}
+
+	// reserve: no rehash while filling what was reserved
+	{
+		std::vector<VertexKey> keys = gridKeys(100, 100);
+		VertexCache cache(101 * 101);
+		size_t capacity = cache.capacity();
+		compareWithMap(keys, cache);
+		CHECK(cache.capacity() == capacity, "reserved " << capacity << ", grew to " << cache.capacity());
+	}
+
+	// clear: keeps the table after a big Mesh, shrinks it after a Mesh 16 times smaller than it, and forgets every key
+	{
+		VertexCache cache;
+		compareWithMap(gridKeys(300, 300), cache);
+		size_t big = cache.capacity();
+		cache.clear();
+		CHECK(cache.size() == 0 && cache.capacity() == big, "cleared to " << cache.size() << " keys in " << cache.capacity());
+		checkSlots(cache);
+		std::vector<VertexKey> small = gridKeys(5, 5);
+		compareWithMap(small, cache);
+		CHECK(cache.capacity() == big, "a small Mesh after clear resized the table to " << cache.capacity());
+		size_t used = cache.size();
+		cache.clear();
+		VertexCache expected(used);
+		CHECK(cache.capacity() == expected.capacity(), "shrunk to " << cache.capacity() << " instead of " << expected.capacity());
+		checkSlots(cache);
+		compareWithMap(small, cache);
+		cache.clear();
+		compareWithMap(randomKeys(rng, 5000, 50), cache);
+	}
+	return checkReport("VertexCacheTest");
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "ScalarVml.hpp"
+#include "Check.hpp"
+
+using vml::vec3;
+
+// matrices multiplied per run, and vec3 of the batched operations (about a large mesh, with a scalar tail)
+static const size_t	MATRICES = 1 << 16;
+static const size_t	VECTORS = (1 << 20) + 3;
+static const int	RUNS = 5;
+
+#if defined(__AVX__)
+static const char*	KERNELS = "AVX";
+#elif defined(__SSE__) || defined(_M_X64)
+static const char*	KERNELS = "SSE";
+#else
+static const char*	KERNELS = "scalar";
+#endif
+
+/// @brief print the time per element of the generic templates and of the kernel
+/// @return false if they did not give the same bytes
+static bool report(const char* name, size_t count, double scalarMs, double simdMs, const void* expected, const void* res, size_t bytes) {
+	bool same = std::memcmp(expected, res, bytes) == 0;
+	printf("  %-24s %8.2f %8.2f  x%.1f%s\n", name, scalarMs * 1e6 / count, simdMs * 1e6 / count, scalarMs / simdMs, same ? "" : "  MISMATCH");
+	return same;
+}
+
+/// @brief the vml::simd kernels against the loops of the generic templates, mat4 products over arrays of matrices and the
+/// batched vec3 operations over one array
+int main() {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(-100.f, 100.f);
+	std::vector<float> a(MATRICES * 16), b(MATRICES * 16), expected(MATRICES * 16), res(MATRICES * 16);
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = dist(rng);
+		b[i] = dist(rng);
+	}
+	std::vector<vec3> va(VECTORS), vb(VECTORS), vecExpected(VECTORS), vecRes(VECTORS);
+	for (size_t i = 0; i < VECTORS; i++)
+		for (int k = 0; k < 3; k++) {
+			va[i][k] = dist(rng);
+			vb[i][k] = dist(rng);
+		}
+	std::vector<float> dotExpected(VECTORS), dotRes(VECTORS);
+	bool same = true;
+
+	printf("VmlBench: %s kernels, ns per element (best of %d)\n", KERNELS, RUNS);
+	printf("  %-24s %8s %8s\n", "", "generic", "kernel");
+	double scalarMs = bestMs(RUNS, [&]() {
+		for (size_t m = 0; m < MATRICES; m++)
+			scalarMat4Mul(&a[m * 16], &b[m * 16], &expected[m * 16]);
+	});
+	double simdMs = bestMs(RUNS, [&]() {
+		for (size_t m = 0; m < MATRICES; m++)
+			vml::simd::mat4Mul(&a[m * 16], &b[m * 16], &res[m * 16]);
+	});
+	same &= report("mat4 * mat4", MATRICES, scalarMs, simdMs, expected.data(), res.data(), res.size() * sizeof(float));
+	scalarMs = bestMs(RUNS, [&]() {
+		for (size_t m = 0; m < MATRICES; m++)
+			scalarMat4MulVec4(&a[m * 16], &b[m * 16], &expected[m * 16]);
+	});
+	simdMs = bestMs(RUNS, [&]() {
+		for (size_t m = 0; m < MATRICES; m++)
+			vml::simd::mat4MulVec4(&a[m * 16], &b[m * 16], &res[m * 16]);
+	});
+	same &= report("mat4 * vec4", MATRICES, scalarMs, simdMs, expected.data(), res.data(), res.size() * sizeof(float));
+
+	scalarMs = bestMs(RUNS, [&]() {scalarDot(va.data(), vb.data(), dotExpected.data(), VECTORS);});
+	simdMs = bestMs(RUNS, [&]() {vml::dot(va.data(), vb.data(), dotRes.data(), VECTORS);});
+	same &= report("dot (vec3 arrays)", VECTORS, scalarMs, simdMs, dotExpected.data(), dotRes.data(), VECTORS * sizeof(float));
+	scalarMs = bestMs(RUNS, [&]() {scalarCross(va.data(), vb.data(), vecExpected.data(), VECTORS);});
+	simdMs = bestMs(RUNS, [&]() {vml::cross(va.data(), vb.data(), vecRes.data(), VECTORS);});
+	same &= report("cross (vec3 arrays)", VECTORS, scalarMs, simdMs, vecExpected.data(), vecRes.data(), VECTORS * sizeof(vec3));
+	scalarMs = bestMs(RUNS, [&]() {scalarNormalize(va.data(), vecExpected.data(), VECTORS);});
+	simdMs = bestMs(RUNS, [&]() {vml::normalize(va.data(), vecRes.data(), VECTORS);});
+	same &= report("normalize (vec3 arrays)", VECTORS, scalarMs, simdMs, vecExpected.data(), vecRes.data(), VECTORS * sizeof(vec3));
+	return same ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "ScalarVml.hpp"
+#include "Check.hpp"
+
+using vml::vec3;
+
+// vml.hpp picks its kernels when it is compiled: make test builds this file at -O2, at -O0 and with -mavx
+#if defined(__OPTIMIZE__)
+# define TEST_BUILD "optimized"
+#else
+# define TEST_BUILD "-O0"
+#endif
+#if defined(__AVX__)
+static const char*	TEST_NAME = "VmlTest (AVX kernels, " TEST_BUILD ")";
+#elif defined(__SSE__) || defined(_M_X64)
+static const char*	TEST_NAME = "VmlTest (SSE kernels, " TEST_BUILD ")";
+#else
+static const char*	TEST_NAME = "VmlTest (scalar kernels, " TEST_BUILD ")";
+#endif
+// vec3 counts checked one by one, every tail of the 4-wide loops and several full blocks
+static const size_t	MAX_COUNT = 21;
+// sentinel after the count results, the kernels must not write past them
+static const float	GUARD = -12345.f;
+
+static std::mt19937	rng(42);
+
+/// @brief same bits, or both NaN (0 / 0 of a normalized zero vector)
+static bool same(float a, float b) {
+	return std::memcmp(&a, &b, sizeof(float)) == 0 || (a != a && b != b);
+}
+
+/// @brief a float of a mesh: mostly in [-100, 100], sometimes 0, tiny, huge or negative zero
+static float randomFloat() {
+	static const float specials[] = {0.f, -0.f, 1.f, -1.f, 1e-30f, -1e-30f, 1e30f, 1e-40f};
+	if (rng() % 16 == 0)
+		return specials[rng() % (sizeof(specials) / sizeof(*specials))];
+	return std::uniform_real_distribution<float>(-100.f, 100.f)(rng);
+}
+
+static std::vector<vec3> randomVec3(size_t count) {
+	std::vector<vec3> vecs(count);
+	for (vec3& v : vecs)
+		for (float& f : v.data)
+			f = randomFloat();
+	return vecs;
+}
+
+/// @brief mat4Mul and mat4MulVec4 against the loops of the generic templates, and mat4 operator* which uses them
+static void checkMatrices() {
+	for (int n = 0; n < 20000; n++) {
+		float a[16], b[16], v[4], expected[16], res[16];
+		for (float& f : a)
+			f = randomFloat();
+		for (float& f : b)
+			f = randomFloat();
+		for (float& f : v)
+			f = randomFloat();
+		scalarMat4Mul(a, b, expected);
+		vml::simd::mat4Mul(a, b, res);
+		for (int i = 0; i < 16; i++)
+			CHECK(same(res[i], expected[i]), "mat4Mul[" << i << "] " << res[i] << " instead of " << expected[i]);
+		vml::mat4 ma, mb;
+		std::memcpy(ma.data, a, sizeof(a));
+		std::memcpy(mb.data, b, sizeof(b));
+		vml::mat4 product = ma * mb;
+		for (int i = 0; i < 16; i++)
+			CHECK(same(product.data[i], expected[i]), "mat4 * mat4 [" << i << "] " << product.data[i] << " instead of " << expected[i]);
+
+		scalarMat4MulVec4(a, v, expected);
+		vml::simd::mat4MulVec4(a, v, res);
+		vml::vec4 vec{v[0], v[1], v[2], v[3]};
+		vml::vec4 transformed = ma * vec;
+		for (int i = 0; i < 4; i++) {
+			CHECK(same(res[i], expected[i]), "mat4MulVec4[" << i << "] " << res[i] << " instead of " << expected[i]);
+			CHECK(same(transformed[i], expected[i]), "mat4 * vec4 [" << i << "] " << transformed[i] << " instead of " << expected[i]);
+		}
+	}
+}
+
+#if defined(__SSE__) || defined(_M_X64)
+/// @brief loadVec3x4 puts the x, y and z of 4 packed vec3 in their lanes, and storeVec3x4 writes them back in place
+static void checkTranspose() {
+	float packed[12], x[4], y[4], z[4], stored[12];
+	for (int i = 0; i < 12; i++)
+		packed[i] = static_cast<float>(i + 1);
+	__m128 rx, ry, rz;
+	vml::simd::loadVec3x4(packed, rx, ry, rz);
+	_mm_storeu_ps(x, rx);
+	_mm_storeu_ps(y, ry);
+	_mm_storeu_ps(z, rz);
+	for (int i = 0; i < 4; i++) {
+		CHECK(x[i] == packed[i * 3], "x lane " << i << " " << x[i]);
+		CHECK(y[i] == packed[i * 3 + 1], "y lane " << i << " " << y[i]);
+		CHECK(z[i] == packed[i * 3 + 2], "z lane " << i << " " << z[i]);
+	}
+	vml::simd::storeVec3x4(stored, rx, ry, rz);
+	for (int i = 0; i < 12; i++)
+		CHECK(stored[i] == packed[i], "stored float " << i << " " << stored[i]);
+}
+#endif
+
+/// @brief batched dot, cross and normalize against the vec3 methods for every count up to MAX_COUNT and a long array,
+/// nothing written after the count results, and out aliasing an input where it is allowed
+static void checkBatched() {
+	std::vector<size_t> counts;
+	for (size_t count = 0; count <= MAX_COUNT; count++)
+		counts.push_back(count);
+	counts.push_back(1003);
+	for (int run = 0; run < 50; run++)
+		for (size_t count : counts) {
+			std::vector<vec3> a = randomVec3(count), b = randomVec3(count);
+			std::vector<float> dots(count + 4, GUARD), expectedDots(count);
+			vml::dot(a.data(), b.data(), dots.data(), count);
+			scalarDot(a.data(), b.data(), expectedDots.data(), count);
+			for (size_t i = 0; i < count; i++)
+				CHECK(same(dots[i], expectedDots[i]), "dot " << i << " of " << count << ": " << dots[i] << " instead of " << expectedDots[i]);
+			for (size_t i = count; i < count + 4; i++)
+				CHECK(dots[i] == GUARD, "dot of " << count << " wrote float " << i);
+
+			std::vector<vec3> crosses(count + 2, vec3(GUARD)), expectedCrosses(count);
+			vml::cross(a.data(), b.data(), crosses.data(), count);
+			scalarCross(a.data(), b.data(), expectedCrosses.data(), count);
+			for (size_t i = 0; i < count; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(same(crosses[i][k], expectedCrosses[i][k]), "cross " << i << "." << k << " of " << count << ": " << crosses[i][k]
+						<< " instead of " << expectedCrosses[i][k]);
+			for (size_t i = count; i < count + 2; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(crosses[i][k] == GUARD, "cross of " << count << " wrote vec3 " << i);
+			std::vector<vec3> inPlace = a;
+			vml::cross(inPlace.data(), b.data(), inPlace.data(), count);
+			for (size_t i = 0; i < count; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(same(inPlace[i][k], expectedCrosses[i][k]), "cross in place " << i << "." << k << " of " << count);
+
+			std::vector<vec3> normals(count + 2, vec3(GUARD)), expectedNormals(count);
+			vml::normalize(a.data(), normals.data(), count);
+			scalarNormalize(a.data(), expectedNormals.data(), count);
+			for (size_t i = 0; i < count; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(same(normals[i][k], expectedNormals[i][k]), "normalize " << i << "." << k << " of " << count << ": " << normals[i][k]
+						<< " instead of " << expectedNormals[i][k]);
+			for (size_t i = count; i < count + 2; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(normals[i][k] == GUARD, "normalize of " << count << " wrote vec3 " << i);
+			vml::normalize(a.data(), a.data(), count);
+			for (size_t i = 0; i < count; i++)
+				for (int k = 0; k < 3; k++)
+					CHECK(same(a[i][k], expectedNormals[i][k]), "normalize in place " << i << "." << k << " of " << count);
+		}
+}
+
+/// @brief the vml::simd kernels give the same bits as the generic templates (same operations in the same order, no FMA)
+int main() {
+#if defined(__AVX__) && defined(__GNUC__)
+	if (!__builtin_cpu_supports("avx")) {
+		std::cout << TEST_NAME << ": skipped, no AVX on this CPU" << std::endl;
+		return 0;
+	}
+#endif
+	checkMatrices();
+#if defined(__SSE__) || defined(_M_X64)
+	checkTranspose();
+#endif
+	checkBatched();
+	return checkReport(TEST_NAME);
+}
@@ -2,6 +2,8 @@
 #include <fstream>
 #include <iomanip>
 #include <string>
+#include <cstdint>
+#include <sys/stat.h>
 #include <boost/json.hpp>
 // #include <iostream>
 
@@ -18,6 +20,20 @@ void strTrim(std::string& str, std::string arr = " \t\r\n") {
 	str = str.substr(start, end - start + 1);	
 }
 
+/// @brief get the size and modification time (in ns) of a file, the freshness stamp of the .scopbin and .scoptex caches
+/// @param path file path
+/// @param size reference set to the file size
+/// @param mtime reference set to the file modification time, in ns
+/// @return false if the file does not exist
+bool fileStamp(const std::string& path, int64_t& size, int64_t& mtime) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return false;
+	size = st.st_size;
+	mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	return true;
+}
+
 /// @brief open and load file in a string
 /// @param filePath path absolute or relative to file to open
 /// @return stingify file
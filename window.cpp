@@ -1,23 +1,43 @@
 #include "Includes/header.h"
+#include "GLState.hpp"
+#include "Profiler.hpp"
 
 #include "Includes/imgui/imgui.h"
 #include "Includes/imgui/imgui_impl_glfw.h"
 #include "Includes/imgui/imgui_impl_opengl3.h"
+#include <algorithm>
 
 
 /**
  * @brief set of functions needed for initializing the GLFW window with a set name and size
  * 
+ * A hidden window (--bench) falls back to an OSMesa context (Mesa llvmpipe, offscreen) on the GLFW null platform when there
+ * is no display, e.g. a CI box without GPU nor X server.
  * @param name window name that will appears on top of it
+ * @param hidden never show the window, its context is only drawn to offscreen
  * 
  * @return GLFWwindow pointer of the created window
  */
-GLFWwindow* initWindow(std::string name) {
+GLFWwindow* initWindow(std::string name, bool hidden) {
+	auto create = [&]() {
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		if (hidden)
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		return glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, name.size() > 0 ? name.c_str() : "Scop42", NULL, NULL);
+	};
 	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	return glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, name.size() > 0 ? name.c_str() : "Scop42", NULL, NULL);
+	GLFWwindow* window = create();
+	if (window || !hidden)
+		return window;
+	// no display
+	glfwTerminate();
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	if (!glfwInit())
+		return NULL;
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+	return create();
 }
 
 /**
@@ -36,18 +56,118 @@ void initImgui(GLFWwindow* window) {
 	ImGui_ImplOpenGL3_Init("#version 330");
 }
 
+// a section of the finished frames for ImGui::PlotLines, oldest first
+struct SectionPlot {
+	ProfileSection	section;
+	bool			gpu;
+};
+
+/// @brief Utilitary function giving a value of the profiler history to ImGui::PlotLines / PlotHistogram (idx 0 the oldest frame)
+/// @param data SectionPlot to plot, null for the frame length
+static float plotValue(void* data, int idx) {
+	Profiler& profiler = Profiler::instance();
+	const FrameRecord& frame = profiler.record(profiler.frames() - 1 - idx);
+	if (!data)
+		return frame.frameMs;
+	SectionPlot* plot = static_cast<SectionPlot*>(data);
+	// no GPU time is drawn as 0 rather than stretching the scale
+	return plot->gpu ? std::max(frame.gpuMs[plot->section], 0.f) : frame.cpuMs[plot->section];
+}
+
+/**
+ * @brief Profiler panel, next to the Settings window: length of the last frames, CPU / GPU time of each section with its
+ * history, the GL counters of the last frame, and the CSV dump of the history (setup.profileCsv)
+ * @param settingsPos position of the Settings window
+ * @param settingsSize size of the Settings window
+ */
+static void createProfilerImgui(ImVec2 settingsPos, ImVec2 settingsSize) {
+	static std::string dumpStatus;
+	Profiler& profiler = Profiler::instance();
+	int count = static_cast<int>(profiler.frames());
+
+	ImGui::SetNextWindowPos(ImVec2(settingsPos.x + settingsSize.x + 10.f, settingsPos.y), ImGuiCond_Always);
+	ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+	if (!count) {
+		ImGui::Text("Waiting for the first frame...");
+		ImGui::End();
+		return;
+	}
+
+	const FrameRecord& last = profiler.record(0);
+	float total = 0.f;
+	for (int i = 0; i < count; i++)
+		total += profiler.record(i).frameMs;
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.2f ms (%.0f fps)", last.frameMs, last.frameMs > 0.f ? 1000.f / last.frameMs : 0.f);
+	ImGui::Text("Frame: average %.2f ms over %d frames", total / count, count);
+	ImGui::PlotHistogram("##frame", plotValue, nullptr, count, 0, overlay, 0.f, FLT_MAX, ImVec2(300.f, 60.f));
+
+	ImGui::Text("%-9s %9s %9s", "section", "CPU ms", "GPU ms");
+	for (int s = 0; s < PROFILE_SECTION_COUNT; s++) {
+		if (last.gpuMs[s] < 0.f)
+			ImGui::Text("%-9s %9.3f %9s", Profiler::name(static_cast<ProfileSection>(s)), last.cpuMs[s], "-");
+		else
+			ImGui::Text("%-9s %9.3f %9.3f", Profiler::name(static_cast<ProfileSection>(s)), last.cpuMs[s], last.gpuMs[s]);
+	}
+	ImGui::Text("%zu meshes, %zu draws, %zu triangles", last.meshes, last.calls.draws, last.calls.triangles);
+	ImGui::Text("%zu state changes, %zu uniform uploads", last.calls.stateChanges, last.calls.uniforms);
+
+	if (ImGui::CollapsingHeader("Timelines")) {
+		static SectionPlot plots[PROFILE_SECTION_COUNT][2];
+		for (int s = 0; s < PROFILE_SECTION_COUNT; s++) {
+			ProfileSection section = static_cast<ProfileSection>(s);
+			plots[s][0] = {section, false};
+			plots[s][1] = {section, true};
+			char label[32];
+			snprintf(label, sizeof(label), "%s CPU", Profiler::name(section));
+			ImGui::PlotLines(label, plotValue, &plots[s][0], count, 0, nullptr, 0.f, FLT_MAX, ImVec2(220.f, 35.f));
+			// only the sections timed on the GPU (see Profiler) have a GPU time
+			bool gpu = false;
+			for (int i = 0; i < count && !gpu; i++)
+				gpu = profiler.record(i).gpuMs[s] >= 0.f;
+			if (gpu) {
+				snprintf(label, sizeof(label), "%s GPU", Profiler::name(section));
+				ImGui::PlotLines(label, plotValue, &plots[s][1], count, 0, nullptr, 0.f, FLT_MAX, ImVec2(220.f, 35.f));
+			}
+		}
+	}
+
+	if (ImGui::Button("Dump CSV"))
+		dumpStatus = profiler.dumpCsv(setup.profileCsv) ? "Written to " + setup.profileCsv : "Could not write " + setup.profileCsv;
+	if (!dumpStatus.empty()) {
+		ImGui::SameLine();
+		ImGui::Text("%s", dumpStatus.c_str());
+	}
+	ImGui::End();
+}
+
 /**
  * @brief create and draw Imgui frame on the window and fill it with the details of the program
  * 
- * Give details on the view mode activated, the light parameter and the legend on the controls
+ * Give details on the view mode activated, the light parameter and the legend on the controls, and the progress of a progressive load.
+ * The Profiler panel is put on its right
+ * @param object displayed Model
  */
-void createUIImgui(){
+void createUIImgui(Model& object){
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 
 	ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
 
+	if (object.streaming()) {
+		float parsed = object.bytesParsed() / (1024.f * 1024.f);
+		float total = object.bytesTotal() / (1024.f * 1024.f);
+		char label[64];
+		snprintf(label, sizeof(label), "%.1f / %.1f MB", parsed, total);
+		ImGui::Text("Loading %s (%zu meshes)", setup.modelName.c_str(), object.ms());
+		ImGui::ProgressBar(total > 0 ? parsed / total : 0.f, ImVec2(-1.f, 0.f), label);
+	}
+	if (object.texturesPending())
+		ImGui::Text("Decoding %zu textures...", object.texturesPending());
+	const GLCallStats& calls = GLState::instance().stats();
+	ImGui::Text("GL calls: %zu (%zu draws, %zu redundant skipped)", calls.calls, calls.draws, calls.skipped);
+
 	ImGui::SliderFloat("Scale", &setup.scaleFactor, 0.1f, 10.0f);
 	ImGui::Checkbox("Show Faces (F)", &setup.showFaces);
 	ImGui::Checkbox("Show Lines (L)", &setup.showLines);
@@ -73,7 +193,10 @@ void createUIImgui(){
 	
 	ImGui::TextColored({0.8,0.8,0,1} ,"Reset Position & Camera (R)\n");
 
+	ImVec2 settingsPos = ImGui::GetWindowPos();
+	ImVec2 settingsSize = ImGui::GetWindowSize();
 	ImGui::End();
+	createProfilerImgui(settingsPos, settingsSize);
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());